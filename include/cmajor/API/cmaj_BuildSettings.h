@@ -42,7 +42,9 @@ struct BuildSettings
     bool         shouldDumpDebugInfo() const               { return getWithDefault (debugMember, false); }
     bool         isDebugFlagSet() const                    { return getWithDefault (debugMember, false); }
     bool         shouldUseFastMaths() const                { return getOptimisationLevel() >= 4; }
+    int          getMathsApproximationLevel() const        { return getWithRangeCheck (mathsApproximationLevelMember, 0, 2, 0); }
     std::string  getMainProcessor() const                  { return getWithDefault (mainProcessorMember, ""); }
+    std::string  getSIMDTarget() const                     { return getWithDefault (simdTargetMember, ""); }
 
     BuildSettings& setMaxFrequency (double f)              { setProperty (maxFrequencyMember, f); return *this; }
     BuildSettings& setFrequency (double f)                 { setProperty (frequencyMember, f); return *this; }
@@ -52,9 +54,11 @@ struct BuildSettings
     BuildSettings& setEventBufferSize (uint32_t size)      { setProperty (eventBufferSizeMember, static_cast<int32_t> (size)); return *this; }
     BuildSettings& setMaxPoolSize (size_t size)            { setProperty (maxPoolSizeMember, static_cast<int64_t> (size)); return *this; }
     BuildSettings& setOptimisationLevel (int level)        { setProperty (optimisationLevelMember, level); return *this; }
+    BuildSettings& setMathsApproximationLevel (int level)  { setProperty (mathsApproximationLevelMember, level); return *this; }
     BuildSettings& setSessionID (int32_t id)               { setProperty (sessionIDMember, id); return *this; }
     BuildSettings& setDebugFlag (bool b)                   { setProperty (debugMember, b); return *this; }
     BuildSettings& setMainProcessor (std::string_view s)   { setProperty (mainProcessorMember, s); return *this; }
+    BuildSettings& setSIMDTarget (std::string_view s)      { setProperty (simdTargetMember, s); return *this; }
 
     void reset()                                           { settings = choc::value::Value(); }
 
@@ -123,10 +127,12 @@ private:
     static constexpr auto eventBufferSizeMember    = "eventBufferSize";
     static constexpr auto maxPoolSizeMember        = "maxAllocPoolSize";
     static constexpr auto optimisationLevelMember  = "optimisationLevel";
+    static constexpr auto mathsApproximationLevelMember = "mathsApproximationLevel";
     static constexpr auto sessionIDMember          = "sessionID";
     static constexpr auto ignoreWarningsMember     = "ignoreWarnings";
     static constexpr auto debugMember              = "debug";
     static constexpr auto mainProcessorMember      = "mainProcessor";
+    static constexpr auto simdTargetMember         = "simdTarget";
 
     template <typename Type>
     Type getWithDefault (std::string_view name, Type defaultValue) const
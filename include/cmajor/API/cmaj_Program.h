@@ -53,6 +53,19 @@ struct Program
                 const std::string& filename,
                 const std::string& fileContent);
 
+    /// A filename and its content, for use with the version of parse() that takes
+    /// a list of files.
+    struct FileToParse
+    {
+        std::string filename, content;
+    };
+
+    /// Parses a group of files in order, stopping at the first one that fails.
+    /// Once they've been parsed, the compiler parses them in parallel whenever the
+    /// program needs reparsing for a new load.
+    bool parse (DiagnosticMessageList& messages,
+                const std::vector<FileToParse>& files);
+
     /// Returns a JSON version of the current syntax tree.
     std::string getSyntaxTree (const SyntaxTreeOptions&) const;
 
@@ -101,6 +114,16 @@ inline bool Program::parse (DiagnosticMessageList& messages,
     return true;
 }
 
+inline bool Program::parse (DiagnosticMessageList& messages,
+                            const std::vector<FileToParse>& files)
+{
+    for (auto& f : files)
+        if (! parse (messages, f.filename, f.content))
+            return false;
+
+    return true;
+}
+
 inline std::string Program::getSyntaxTree (const SyntaxTreeOptions& options) const
 {
     if (program == nullptr)
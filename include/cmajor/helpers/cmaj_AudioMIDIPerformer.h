@@ -19,6 +19,7 @@
 #pragma once
 
 #include <iostream>
+#include <atomic>
 
 #include "../../choc/memory/choc_Endianness.h"
 #include "../../choc/containers/choc_VariableSizeFIFO.h"
@@ -29,6 +30,7 @@
 #include "../../choc/audio/choc_AudioMIDIBlockDispatcher.h"
 
 #include "cmaj_EndpointTypeCoercion.h"
+#include "cmaj_ThreadPools.h"
 
 
 namespace cmaj
@@ -80,6 +82,11 @@ struct AudioMIDIPerformer
         /// a call to handlePendingOutputEvents() either synchronously or asynchronously.
         bool setEventOutputHandler (OutputEventsReadyFn);
 
+        /// Gives the performer a pool of worker threads that can be used to spread the
+        /// work within each block across multiple cores. The pool is owned by the host,
+        /// and may be shared between performers that are never run concurrently.
+        void setWorkerThreadPool (std::shared_ptr<RealtimeThreadPool>);
+
         /// Note that after creating the performer, this builder object can no longer
         /// be used - to create more performers, use new instances of the Builder
         std::unique_ptr<AudioMIDIPerformer> createPerformer();
@@ -99,8 +106,10 @@ struct AudioMIDIPerformer
     };
 
     //==============================================================================
-    // These can be called from any thread - it adds these incoming events and value changes
-    // to a FIFO that will be read during the next call to process()
+    // These can be called from any thread. Events are added to a FIFO that will be read
+    // during the next call to process(). Values are written to a per-endpoint slot which
+    // only holds the most recent value, so posting a value only has to wait (for up to the
+    // timeout) if several other threads are posting to the same endpoint at that moment.
     bool postEvent (const cmaj::EndpointID&, const choc::value::ValueView& value, uint32_t timeoutMilliseconds);
     bool postEvent (cmaj::EndpointHandle,    const choc::value::ValueView& value, uint32_t timeoutMilliseconds);
     bool postValue (const cmaj::EndpointID&, const choc::value::ValueView& value, uint32_t framesToReachValue, uint32_t timeoutMilliseconds);
@@ -138,6 +147,10 @@ struct AudioMIDIPerformer
     /// work, it needs to be called regularly (at least a few times per second) by another thread.
     bool isStuckInInfiniteLoop (uint32_t thresholdMilliseconds = 500);
 
+    /// Returns the worker pool that the host supplied, or nullptr if there isn't one.
+    /// This may only be used from within the process callback.
+    RealtimeThreadPool* getWorkerThreadPool() const     { return workerThreadPool.get(); }
+
     cmaj::Engine engine;
     cmaj::Performer performer;
 
@@ -152,7 +165,48 @@ private:
     std::vector<std::pair<cmaj::EndpointHandle, std::string>> eventOutputHandles;
     std::unordered_map<std::string, EndpointHandle> inputEndpointHandles;
     choc::fifo::VariableSizeFIFO inputQueue, outputQueue;
+
+    //==============================================================================
+    /// Holds the latest value posted to a value endpoint. Any number of threads may write
+    /// to it: each writer claims a free buffer, fills it, and then swaps it in as the latest
+    /// one, so neither the writers nor the audio thread ever hold a lock. Repeated writes
+    /// between two calls to process() simply replace each other.
+    struct InputValueSlot
+    {
+        InputValueSlot (EndpointHandle, uint32_t dataSize);
+
+        /// Calls fillBuffer (void* dest) to write the new value into a free buffer, and
+        /// returns false if that fails, or if no buffer became free within the timeout (which
+        /// can only happen when more than (numBuffers - 2) threads are writing at once).
+        template <typename FillFn>
+        bool write (uint32_t framesToReachValue, uint32_t timeoutMilliseconds, FillFn&& fillBuffer);
+
+        template <typename HandlerFn>
+        void readIfChanged (HandlerFn&&);
+
+        const EndpointHandle handle;
+
+    private:
+        // One buffer may be held by the reader and one may be waiting to be read, so
+        // the rest are available to writers that are in the middle of copying their data
+        static constexpr uint32_t numBuffers = 4, noBuffer = numBuffers;
+
+        const uint32_t dataSize;
+        std::vector<uint8_t> storage;
+        uint32_t framesToReachValue[numBuffers] = {};
+        std::atomic<uint32_t> freeBufferMask { (1u << numBuffers) - 1u };
+        std::atomic<uint32_t> latestIndex { noBuffer };
+
+        uint8_t* getBuffer (uint32_t index)     { return storage.data() + index * dataSize; }
+        uint32_t claimFreeBuffer();
+        void releaseBuffer (uint32_t index)     { freeBufferMask.fetch_or (1u << index, std::memory_order_release); }
+    };
+
+    std::vector<std::unique_ptr<InputValueSlot>> inputValueSlots;
+    std::unordered_map<EndpointHandle, InputValueSlot*> inputValueSlotsByHandle;
+
     OutputEventsReadyFn outputEventsReadyHandler;
+    std::shared_ptr<RealtimeThreadPool> workerThreadPool;
     std::vector<std::pair<choc::midi::ShortMessage, uint32_t>> midiOutputMessages;
     choc::buffer::InterleavingScratchBuffer<float> audioInputScratchBuffer;
     std::vector<uint8_t> audioOutputScratchSpace;
@@ -170,6 +224,8 @@ private:
     AudioMIDIPerformer (cmaj::Engine, uint32_t eventFIFOSize);
 
     void allocateScratch();
+    void createInputValueSlots();
+    void dispatchInputValues();
     void dispatchMIDIOutputEvents (const choc::audio::AudioMIDIBlockDispatcher::Block&);
     void moveOutputEventsToQueue();
 };
@@ -534,6 +590,11 @@ inline bool AudioMIDIPerformer::Builder::setEventOutputHandler (OutputEventsRead
     return ! result->eventOutputHandles.empty();
 }
 
+inline void AudioMIDIPerformer::Builder::setWorkerThreadPool (std::shared_ptr<RealtimeThreadPool> pool)
+{
+    result->workerThreadPool = std::move (pool);
+}
+
 inline std::unique_ptr<AudioMIDIPerformer> AudioMIDIPerformer::Builder::createPerformer()
 {
     createOutputChannelClearAction();
@@ -553,6 +614,7 @@ inline AudioMIDIPerformer::AudioMIDIPerformer (cmaj::Engine e, uint32_t eventFIF
         inputEndpointHandles[endpoint.endpointID.toString()] = engine.getEndpointHandle (endpoint.endpointID);
 
     allocateScratch();
+    createInputValueSlots();
 }
 
 inline AudioMIDIPerformer::~AudioMIDIPerformer()
@@ -576,6 +638,101 @@ inline void AudioMIDIPerformer::allocateScratch()
         audioOutputScratchSpace.resize (scratchNeeded);
 }
 
+inline void AudioMIDIPerformer::createInputValueSlots()
+{
+    for (auto& endpoint : engine.getInputEndpoints())
+    {
+        if (endpoint.isValue())
+        {
+            auto handle = engine.getEndpointHandle (endpoint.endpointID);
+            auto dataSize = static_cast<uint32_t> (endpoint.dataTypes.front().getValueDataSize());
+
+            inputValueSlots.push_back (std::make_unique<InputValueSlot> (handle, dataSize));
+            inputValueSlotsByHandle[handle] = inputValueSlots.back().get();
+        }
+    }
+}
+
+inline AudioMIDIPerformer::InputValueSlot::InputValueSlot (EndpointHandle h, uint32_t size)
+    : handle (h), dataSize (size)
+{
+    storage.resize (numBuffers * static_cast<size_t> (dataSize));
+}
+
+inline uint32_t AudioMIDIPerformer::InputValueSlot::claimFreeBuffer()
+{
+    auto mask = freeBufferMask.load (std::memory_order_relaxed);
+
+    while (mask != 0)
+    {
+        uint32_t index = 0;
+
+        while ((mask & (1u << index)) == 0)
+            ++index;
+
+        if (freeBufferMask.compare_exchange_weak (mask, mask & ~(1u << index), std::memory_order_acquire, std::memory_order_relaxed))
+            return index;
+    }
+
+    return noBuffer;
+}
+
+template <typename FillFn>
+bool AudioMIDIPerformer::InputValueSlot::write (uint32_t frames, uint32_t timeoutMilliseconds, FillFn&& fillBuffer)
+{
+    auto index = claimFreeBuffer();
+
+    if (index == noBuffer)
+    {
+        if (timeoutMilliseconds == 0)
+            return false;
+
+        for (auto startTime = std::chrono::steady_clock::now();;)
+        {
+            std::this_thread::yield();
+            index = claimFreeBuffer();
+
+            if (index != noBuffer)
+                break;
+
+            if (std::chrono::steady_clock::now() - startTime > std::chrono::milliseconds (timeoutMilliseconds))
+                return false;
+        }
+    }
+
+    if (! fillBuffer (static_cast<void*> (getBuffer (index))))
+    {
+        releaseBuffer (index);
+        return false;
+    }
+
+    framesToReachValue[index] = frames;
+
+    // Whichever thread takes a buffer out of latestIndex becomes its owner, so if this
+    // replaces a value that the reader hasn't seen, it's up to this writer to free it
+    auto replaced = latestIndex.exchange (index, std::memory_order_acq_rel);
+
+    if (replaced != noBuffer)
+        releaseBuffer (replaced);
+
+    return true;
+}
+
+template <typename HandlerFn>
+void AudioMIDIPerformer::InputValueSlot::readIfChanged (HandlerFn&& handler)
+{
+    if (latestIndex.load (std::memory_order_relaxed) == noBuffer)
+        return;
+
+    auto index = latestIndex.exchange (noBuffer, std::memory_order_acq_rel);
+
+    if (index != noBuffer)
+    {
+        handler (handle, getBuffer (index), framesToReachValue[index]);
+        releaseBuffer (index);
+    }
+}
+
 template <typename Fifo, typename Fn>
 static bool pushWithTimeout (Fifo& fifo, uint32_t totalSize, uint32_t timeoutMilliseconds, Fn&& f)
 {
@@ -633,19 +790,11 @@ inline bool AudioMIDIPerformer::postEvent (const cmaj::EndpointID& endpointID, c
 inline bool AudioMIDIPerformer::postValue (const EndpointHandle handle, const choc::value::ValueView& value,
                                            uint32_t framesToReachValue, uint32_t timeoutMilliseconds)
 {
-    if (auto coercedData = endpointTypeCoercionHelpers.coerceValue (handle, value))
+    if (auto slot = inputValueSlotsByHandle.find (handle); slot != inputValueSlotsByHandle.end())
     {
-        auto totalSize = static_cast<uint32_t> (sizeof (handle) + sizeof (framesToReachValue) + coercedData.size);
-
-        return pushWithTimeout (inputQueue, totalSize, timeoutMilliseconds, [&] (void* dest)
+        return slot->second->write (framesToReachValue, timeoutMilliseconds, [&] (void* dest)
         {
-            auto d = static_cast<uint8_t*> (dest);
-            choc::memory::writeNativeEndian (d, handle);
-            d += sizeof (handle);
-            // upper bit is used to indicate this is a value rather than event
-            choc::memory::writeNativeEndian (d, framesToReachValue | 0x80000000u);
-            d += sizeof (framesToReachValue);
-            std::memcpy (d, coercedData.data, coercedData.size);
+            return endpointTypeCoercionHelpers.coerceValueInto (handle, value, dest);
         });
     }
 
@@ -728,20 +877,17 @@ inline bool AudioMIDIPerformer::process (const choc::audio::AudioMIDIBlockDispat
         for (auto& f : preRenderFunctions)
             f (block);
 
+        dispatchInputValues();
+
         inputQueue.popAllAvailable ([&] (const void* data, [[maybe_unused]] uint32_t size)
         {
             CMAJ_ASSERT (size > 4);
             auto d = static_cast<const char*> (data);
             auto handle = choc::memory::readNativeEndian<cmaj::EndpointHandle> (d);
             d += sizeof (handle);
-            // upper bit is used to indicate this is a value rather than event
-            auto typeIndexOrFrameCount = choc::memory::readNativeEndian<uint32_t> (d);
-            d += sizeof (typeIndexOrFrameCount);
-
-            if (typeIndexOrFrameCount >> 31)
-                performer.setInputValue (handle, d, typeIndexOrFrameCount & 0x7fffffffu);
-            else
-                performer.addInputEvent (handle, typeIndexOrFrameCount, d);
+            auto typeIndex = choc::memory::readNativeEndian<uint32_t> (d);
+            d += sizeof (typeIndex);
+            performer.addInputEvent (handle, typeIndex, d);
         });
 
         if (! midiInputEndpoints.empty())
@@ -838,6 +984,17 @@ inline bool AudioMIDIPerformer::processWithTimeStampedMIDI (const choc::buffer::
     return false;
 }
 
+inline void AudioMIDIPerformer::dispatchInputValues()
+{
+    for (auto& slot : inputValueSlots)
+    {
+        slot->readIfChanged ([this] (EndpointHandle handle, const void* data, uint32_t framesToReachValue)
+        {
+            performer.setInputValue (handle, data, framesToReachValue);
+        });
+    }
+}
+
 inline void AudioMIDIPerformer::dispatchMIDIOutputEvents (const choc::audio::AudioMIDIBlockDispatcher::Block& block)
 {
     if (! block.onMidiOutputMessage)
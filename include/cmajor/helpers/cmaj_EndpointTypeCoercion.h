@@ -158,6 +158,17 @@ struct EndpointTypeCoercionHelperList
         return {};
     }
 
+    /// Unlike coerceValue(), this writes into the caller's buffer instead of the endpoint's
+    /// scratch space, so several threads may call it at once for the same endpoint.
+    bool coerceValueInto (EndpointHandle handle, const choc::value::ValueView& source, void* dest)
+    {
+        if (auto e = getInput (handle))
+            if (e->endpointType == EndpointType::value)
+                return e->scratchSpaces.front().coerceValueInto (source, dest);
+
+        return false;
+    }
+
     CoercedDataWithIndex coerceValueToMatchingType (EndpointHandle handle, const choc::value::ValueView& source, EndpointType requiredType)
     {
         if (auto e = getInput (handle))
@@ -264,6 +275,11 @@ private:
             return {};
         }
 
+        bool coerceValueInto (const choc::value::ValueView& source, void* dest) const
+        {
+            return coerceChocValue (choc::value::ValueView (type, dest, scratchView.getDictionary()), source);
+        }
+
         CoercedData getCoercedArray (const choc::value::ValueView& source)
         {
             const auto& sourceType = source.getType();
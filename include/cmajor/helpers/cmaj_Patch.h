@@ -22,6 +22,8 @@
 #include "cmaj_AudioMIDIPerformer.h"
 
 #include <mutex>
+#include <atomic>
+#include <cmath>
 #include <unordered_map>
 #include <unordered_set>
 #include <chrono>
@@ -273,6 +275,12 @@ struct Patch
 
     CustomAudioSourcePtr getCustomAudioSourceForInput (const EndpointID&) const;
 
+    /// Supplies a pool of worker threads that subsequent builds will hand to their
+    /// performer. The pool belongs to the host, which should configure it to suit the
+    /// machine and audio device. Pass nullptr to have the patch run single-threaded.
+    void setWorkerThreadPool (std::shared_ptr<RealtimeThreadPool>);
+    std::shared_ptr<RealtimeThreadPool> getWorkerThreadPool() const     { return workerThreadPool; }
+
     /// A client can provide this callback to get a callback when something modifies
     /// one of the patches in the bundle
     std::function<void(PatchFileChangeChecker::ChangeType)> patchFilesChanged;
@@ -301,6 +309,7 @@ private:
     std::shared_ptr<PatchRenderer> renderer;
     PlaybackParams currentPlaybackParams;
     std::unordered_map<std::string, CustomAudioSourcePtr> customAudioInputSources;
+    std::shared_ptr<RealtimeThreadPool> workerThreadPool;
     std::unique_ptr<PatchFileChangeChecker> fileChangeChecker;
     std::vector<PatchView*> activeViews;
     std::unordered_map<std::string, choc::value::Value> storedState;
@@ -649,11 +658,14 @@ struct Patch::ClientEventQueue
     {
         cpu.endProcess (framesProcessedInBlock);
 
-        if (triggerDispatchOnEndOfBlock)
-        {
-            triggerDispatchOnEndOfBlock = false;
+        if (triggerDispatchOnEndOfBlock.exchange (false))
+            clientEventHandlerThread.trigger();
+    }
+
+    void triggerDispatch()
+    {
+        if (triggerDispatchOnEndOfBlock.exchange (false))
             clientEventHandlerThread.trigger();
-        }
     }
 
     void dispatchClientEvents()
@@ -688,7 +700,7 @@ struct Patch::ClientEventQueue
     choc::threading::TaskThread clientEventHandlerThread;
     choc::threading::ThreadSafeFunctor<std::function<void()>> dispatchClientEventsCallback;
     MIDIEvents::SerialisedShortMIDIMessage serialisedMIDIMessage;
-    bool triggerDispatchOnEndOfBlock = false;
+    std::atomic<bool> triggerDispatchOnEndOfBlock { false };
     uint32_t framesProcessedInBlock = 0;
 
     CPUMonitor cpu;
@@ -887,6 +899,226 @@ private:
     bool running = false;
 };
 
+//==============================================================================
+/// Measures the per-channel min and max of a run of interleaved audio frames. Each call
+/// to process() replaces the previous results.
+struct AudioLevelMeter
+{
+    AudioLevelMeter (uint32_t channels)
+        : numChannels (channels),
+          blockMin (numChannels), blockMax (numChannels),
+          laneMin (numChannels * numLanes), laneMax (numChannels * numLanes)
+    {}
+
+    template <typename SampleType>
+    void process (const choc::buffer::InterleavedView<SampleType>& data)
+    {
+        CMAJ_ASSERT (data.getNumChannels() == numChannels);
+        blockNumFrames = data.getNumFrames();
+
+        if (blockNumFrames == 0)
+            return;
+
+        if (data.data.stride == numChannels)
+            processContiguous (data.data.data, blockNumFrames);
+        else
+            processStrided (data);
+    }
+
+    const uint32_t numChannels;
+    uint32_t blockNumFrames = 0;
+    std::vector<float> blockMin, blockMax;
+
+private:
+    // Interleaved data for a run of frames is a contiguous array, so by keeping one set of
+    // accumulators for each sample position within a group of frames, the inner loop becomes
+    // a straight element-wise operation with no dependencies that the compiler can vectorise.
+    static constexpr uint32_t numLanes = 8;
+
+    std::vector<float> laneMin, laneMax;
+
+    template <typename SampleType>
+    void processContiguous (const SampleType* source, uint32_t numFrames)
+    {
+        auto groupSize = numChannels * numLanes;
+        auto numGroups = numFrames / numLanes;
+        auto mins = laneMin.data();
+        auto maxs = laneMax.data();
+
+        for (uint32_t i = 0; i < groupSize; ++i)
+        {
+            auto first = static_cast<float> (source[i % numChannels]);
+            mins[i] = first;
+            maxs[i] = first;
+        }
+
+        for (uint32_t group = 0; group < numGroups; ++group)
+        {
+            for (uint32_t i = 0; i < groupSize; ++i)
+            {
+                auto sample = static_cast<float> (source[i]);
+                mins[i] = sample < mins[i] ? sample : mins[i];
+                maxs[i] = sample > maxs[i] ? sample : maxs[i];
+            }
+
+            source += groupSize;
+        }
+
+        for (uint32_t chan = 0; chan < numChannels; ++chan)
+        {
+            auto mn = mins[chan], mx = maxs[chan];
+
+            for (uint32_t lane = 1; lane < numLanes; ++lane)
+            {
+                auto i = lane * numChannels + chan;
+                mn = std::min (mn, mins[i]);
+                mx = std::max (mx, maxs[i]);
+            }
+
+            blockMin[chan] = mn;
+            blockMax[chan] = mx;
+        }
+
+        for (auto remaining = numFrames - numGroups * numLanes; remaining != 0; --remaining)
+        {
+            for (uint32_t chan = 0; chan < numChannels; ++chan)
+            {
+                auto sample = static_cast<float> (source[chan]);
+                blockMin[chan] = std::min (blockMin[chan], sample);
+                blockMax[chan] = std::max (blockMax[chan], sample);
+            }
+
+            source += numChannels;
+        }
+    }
+
+    template <typename SampleType>
+    void processStrided (const choc::buffer::InterleavedView<SampleType>& data)
+    {
+        for (uint32_t chan = 0; chan < numChannels; ++chan)
+        {
+            auto first = static_cast<float> (data.getSample (chan, 0));
+            blockMin[chan] = first;
+            blockMax[chan] = first;
+        }
+
+        for (uint32_t frame = 0; frame < blockNumFrames; ++frame)
+        {
+            for (uint32_t chan = 0; chan < numChannels; ++chan)
+            {
+                auto sample = static_cast<float> (data.getSample (chan, frame));
+                blockMin[chan] = std::min (blockMin[chan], sample);
+                blockMax[chan] = std::max (blockMax[chan], sample);
+            }
+        }
+    }
+};
+
+//==============================================================================
+/// Carries blocks of audio and MIDI that views are monitoring from the audio thread to a
+/// background thread. Pushing only copies the data into a preallocated FIFO, and if the
+/// reader has fallen behind and the FIFO is full, the data is dropped rather than waited
+/// for. Each audio record is tagged with the index of the source that it came from,
+/// rather than a pointer, so the reader can check that the source still exists.
+struct EndpointMonitorFIFO
+{
+    EndpointMonitorFIFO (uint32_t sizeInBytes)
+    {
+        fifo.reset (sizeInBytes);
+    }
+
+    /// Returns false if there wasn't space for the block
+    template <typename SampleType>
+    bool pushAudio (uint32_t sourceIndex, const choc::buffer::InterleavedView<SampleType>& block)
+    {
+        auto size = block.getSize();
+        auto dataSize = static_cast<uint32_t> (size.numChannels * size.numFrames * sizeof (float));
+
+        return fifo.push (audioHeaderSize + dataSize, [&] (void* dest)
+        {
+            auto d = static_cast<char*> (dest);
+            *d++ = static_cast<char> (RecordType::audio);
+            choc::memory::writeNativeEndian (d, sourceIndex);
+            d += sizeof (uint32_t);
+            choc::memory::writeNativeEndian (d, size.numChannels);
+            d += sizeof (uint32_t);
+            choc::memory::writeNativeEndian (d, size.numFrames);
+            d += sizeof (uint32_t);
+
+            if constexpr (std::is_same_v<SampleType, float>)
+            {
+                if (block.data.stride == size.numChannels)
+                {
+                    std::memcpy (d, block.data.data, dataSize);
+                    return;
+                }
+            }
+
+            copy (choc::buffer::createInterleavedView (reinterpret_cast<float*> (d), size.numChannels, size.numFrames), block);
+        });
+    }
+
+    /// Returns false if there wasn't space for the messages
+    bool pushMIDI (choc::span<const choc::midi::ShortMessage> messages)
+    {
+        auto numMessages = static_cast<uint32_t> (messages.size());
+
+        return fifo.push (1 + numMessages * midiMessageSize, [&] (void* dest)
+        {
+            auto d = static_cast<char*> (dest);
+            *d++ = static_cast<char> (RecordType::midi);
+
+            for (auto& m : messages)
+            {
+                std::memcpy (d, m.data, midiMessageSize);
+                d += midiMessageSize;
+            }
+        });
+    }
+
+    /// Reads everything that's waiting, calling handleAudio (uint32_t sourceIndex,
+    /// const choc::buffer::InterleavedView<const float>&) for each audio block and
+    /// handleMIDI (choc::midi::ShortMessage) for each MIDI message.
+    template <typename AudioHandler, typename MIDIHandler>
+    void popAll (AudioHandler&& handleAudio, MIDIHandler&& handleMIDI)
+    {
+        fifo.popAllAvailable ([&] (const void* data, uint32_t size)
+        {
+            auto d = static_cast<const char*> (data);
+            auto end = d + size;
+
+            if (static_cast<RecordType> (*d++) == RecordType::audio)
+            {
+                auto sourceIndex = choc::memory::readNativeEndian<uint32_t> (d);
+                d += sizeof (uint32_t);
+                auto numChannels = choc::memory::readNativeEndian<uint32_t> (d);
+                d += sizeof (uint32_t);
+                auto numFrames = choc::memory::readNativeEndian<uint32_t> (d);
+                d += sizeof (uint32_t);
+
+                handleAudio (sourceIndex, choc::buffer::createInterleavedView (reinterpret_cast<const float*> (d), numChannels, numFrames));
+            }
+            else
+            {
+                for (; d + midiMessageSize <= end; d += midiMessageSize)
+                    handleMIDI (choc::midi::ShortMessage (d, midiMessageSize));
+            }
+        });
+    }
+
+private:
+    enum class RecordType  : char
+    {
+        audio,
+        midi
+    };
+
+    static constexpr uint32_t audioHeaderSize = 1 + 3 * sizeof (uint32_t);
+    static constexpr uint32_t midiMessageSize = 3;
+
+    choc::fifo::VariableSizeFIFO fifo;
+};
+
 //==============================================================================
 struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer>
 {
@@ -900,6 +1132,7 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
 
     ~PatchRenderer()
     {
+        endpointMonitorTap.stop();
         patchWorker.reset();
         infiniteLoopCheckTimer.clear();
         handleOutputEvent.reset();
@@ -926,7 +1159,8 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
               endpointID (endpoint.endpointID.toString()),
               replyType (std::move (type)),
               sendFullData (fullData),
-              granularity (gran >= minGranularity && gran <= maxGranularity ? gran : defaultGranularity)
+              granularity (gran >= minGranularity && gran <= maxGranularity ? gran : defaultGranularity),
+              meter (endpoint.getNumAudioChannels())
         {
             auto numChannels = endpoint.getNumAudioChannels();
             CMAJ_ASSERT (numChannels > 0);
@@ -937,47 +1171,48 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
                 levels.resize ({ numChannels, 2 });
         }
 
-        template <typename SampleType>
-        void process (ClientEventQueue& queue, const choc::buffer::InterleavedView<SampleType>& data)
-        {
-            if (sendFullData)
-                processFullData (queue, data);
-            else
-                processMinMax (queue, data);
-        }
-
         template <typename SampleType>
         void processMinMax (ClientEventQueue& queue, const choc::buffer::InterleavedView<SampleType>& data)
         {
             auto numFrames = data.getNumFrames();
-            auto numChannels = data.getNumChannels();
+            auto numChannels = levels.getNumChannels();
+            choc::buffer::FrameCount sourceStart = 0;
 
-            for (uint32_t i = 0; i < numFrames; ++i)
+            // The block is metered in chunks that end on granularity boundaries, so that
+            // every post covers exactly the same number of frames
+            while (numFrames != 0)
             {
+                auto numToAdd = std::min (numFrames, granularity - frameCount);
+                meter.process (data.getFrameRange ({ sourceStart, sourceStart + numToAdd }));
+
                 for (uint32_t chan = 0; chan < numChannels; ++chan)
                 {
-                    auto level = static_cast<float> (data.getSample (chan, i));
                     auto minMax = levels.getIterator (chan);
 
                     if (frameCount == 0)
                     {
-                        *minMax = level;
+                        *minMax = meter.blockMin[chan];
                         ++minMax;
-                        *minMax = level;
+                        *minMax = meter.blockMax[chan];
                     }
                     else
                     {
-                        *minMax = std::min (level, *minMax);
+                        *minMax = std::min (meter.blockMin[chan], *minMax);
                         ++minMax;
-                        *minMax = std::max (level, *minMax);
+                        *minMax = std::max (meter.blockMax[chan], *minMax);
                     }
                 }
 
-                if (++frameCount == granularity)
+                frameCount += numToAdd;
+
+                if (frameCount == granularity)
                 {
                     frameCount = 0;
                     queue.postAudioMinMax (view, replyType, levels);
                 }
+
+                sourceStart += numToAdd;
+                numFrames -= numToAdd;
             }
         }
 
@@ -1024,6 +1259,7 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
 
     private:
         choc::buffer::ChannelArrayBuffer<float> levels;
+        AudioLevelMeter meter;
         uint32_t frameCount = 0;
     };
 
@@ -1041,17 +1277,19 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
     }
 
     //==============================================================================
+    struct EndpointMonitorTap;
+
     struct DataListener  : public AudioMIDIPerformer::AudioDataListener
     {
-        DataListener (ClientEventQueue& c) : queue (c) {}
+        DataListener (EndpointMonitorTap& t, ClientEventQueue& c) : tap (t), queue (c) {}
 
         void process (const choc::buffer::InterleavedView<float>& block) override
         {
             if (customSource != nullptr)
                 customSource->read (block);
 
-            for (auto& m : audioMonitors)
-                m->process (queue, block);
+            if (isMonitored.load (std::memory_order_relaxed))
+                tap.pushAudio (*this, block);
         }
 
         void process (const choc::buffer::InterleavedView<double>& block) override
@@ -1059,8 +1297,26 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
             if (customSource != nullptr)
                 customSource->read (block);
 
+            if (isMonitored.load (std::memory_order_relaxed))
+                tap.pushAudio (*this, block);
+        }
+
+        /// Called on the monitoring thread with a copy of a block that the tap captured
+        void processMonitoredBlock (const choc::buffer::InterleavedView<const float>& block)
+        {
             for (auto& m : audioMonitors)
-                m->process (queue, block);
+            {
+                if (m->sendFullData)
+                    m->processFullData (queue, block);
+                else
+                    m->processMinMax (queue, block);
+            }
+        }
+
+        void addMonitor (std::unique_ptr<AudioLevelMonitor> monitor)
+        {
+            audioMonitors.push_back (std::move (monitor));
+            isMonitored = true;
         }
 
         bool removeMonitor (PatchView& view, const EndpointID& e, const std::string& type)
@@ -1072,6 +1328,7 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
             if (newEnd != oldEnd)
             {
                 audioMonitors.erase (newEnd, oldEnd);
+                isMonitored = ! audioMonitors.empty();
                 return true;
             }
 
@@ -1086,11 +1343,103 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
 
             if (newEnd != oldEnd)
                 audioMonitors.erase (newEnd, oldEnd);
+
+            isMonitored = ! audioMonitors.empty();
         }
 
+        EndpointMonitorTap& tap;
         ClientEventQueue& queue;
+        uint32_t monitorIndex = 0;
         CustomAudioSourcePtr customSource;
         std::vector<std::unique_ptr<AudioLevelMonitor>> audioMonitors;
+        std::atomic<bool> isMonitored { false };
+    };
+
+    //==============================================================================
+    /// Runs endpoint monitoring on a background thread. During the audio callback, the data
+    /// that views have asked to watch is only copied into an EndpointMonitorFIFO, and this
+    /// thread then does the metering, formatting and posting to the client event queue.
+    struct EndpointMonitorTap
+    {
+        EndpointMonitorTap (PatchRenderer& r) : renderer (r) {}
+
+        ~EndpointMonitorTap()
+        {
+            stop();
+        }
+
+        void start()
+        {
+            thread.start (0, [this] { processPendingData(); });
+        }
+
+        void stop()
+        {
+            thread.stop();
+        }
+
+        /// Gives a listener the index that its audio records will be tagged with. The tap
+        /// keeps a reference to it, so it can't be deleted while its data is in the FIFO.
+        void addListener (std::shared_ptr<DataListener> listener)
+        {
+            std::lock_guard<decltype(renderer.monitorLock)> lock (renderer.monitorLock);
+            listener->monitorIndex = static_cast<uint32_t> (listeners.size());
+            listeners.push_back (std::move (listener));
+        }
+
+        template <typename SampleType>
+        void pushAudio (DataListener& listener, const choc::buffer::InterleavedView<SampleType>& block)
+        {
+            if (fifo.pushAudio (listener.monitorIndex, block))
+                dataPending = true;
+        }
+
+        void pushMIDI (choc::span<const choc::midi::ShortMessage> messages)
+        {
+            if (! messages.empty() && fifo.pushMIDI (messages))
+                dataPending = true;
+        }
+
+        void endOfProcessCallback()
+        {
+            if (dataPending)
+            {
+                dataPending = false;
+                thread.trigger();
+            }
+        }
+
+    private:
+        static constexpr uint32_t fifoSize = 1024 * 1024;
+
+        PatchRenderer& renderer;
+        EndpointMonitorFIFO fifo { fifoSize };
+        std::vector<std::shared_ptr<DataListener>> listeners;
+        choc::threading::TaskThread thread;
+        bool dataPending = false;
+
+        void processPendingData()
+        {
+            auto& queue = *renderer.patch.clientEventQueue;
+
+            {
+                std::lock_guard<decltype(renderer.monitorLock)> lock (renderer.monitorLock);
+
+                fifo.popAll ([this] (uint32_t listenerIndex, const choc::buffer::InterleavedView<const float>& block)
+                             {
+                                 if (listenerIndex < listeners.size())
+                                     listeners[listenerIndex]->processMonitoredBlock (block);
+                             },
+                             [&] (choc::midi::ShortMessage message)
+                             {
+                                 for (auto& monitor : renderer.endpointListeners.eventMonitors)
+                                     if (monitor->isMIDI)
+                                         monitor->process (queue, monitor->endpointID, message);
+                             });
+            }
+
+            queue.triggerDispatch();
+        }
     };
 
     //==============================================================================
@@ -1132,6 +1481,10 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
             if (performerBuilder.setEventOutputHandler ([this] { outputEventsReady(); }))
                 startOutputEventThread();
 
+            performerBuilder.setWorkerThreadPool (patch.getWorkerThreadPool());
+
+            endpointMonitorTap.start();
+
             if (createPerformer (performerBuilder))
                 applyParameterValues (loadParams.parameterValues, 0, 0);
         }
@@ -1154,14 +1507,15 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
 
         if (manifest.needsToBuildSource)
         {
+            std::vector<cmaj::Program::FileToParse> filesToParse;
+
             for (auto& file : manifest.sourceFiles)
             {
                 checkForStopSignal();
 
                 if (auto content = manifest.readFileContent (file))
                 {
-                    if (! program.parse (errors, manifest.getFullPathForFile (file), std::move (*content)))
-                        return false;
+                    filesToParse.push_back ({ manifest.getFullPathForFile (file), std::move (*content) });
                 }
                 else
                 {
@@ -1169,6 +1523,11 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
                     return false;
                 }
             }
+
+            checkForStopSignal();
+
+            if (! program.parse (errors, filesToParse))
+                return false;
         }
 
         engine.setBuildSettings (engine.getBuildSettings()
@@ -1178,10 +1537,14 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
 
         checkForStopSignal();
 
-        if (engine.load (errors, program,
-                         shouldResolveExternals ? manifest.createExternalResolverFunction()
-                                                : [] (const cmaj::ExternalVariable&) -> choc::value::Value { return {}; },
-                         {}))
+        auto resolveExternal = shouldResolveExternals
+                                 ? manifest.createExternalResolverFunction ([this] (const std::string& error)
+                                   {
+                                       errors.add (cmaj::DiagnosticMessage::createError (error, {}));
+                                   })
+                                 : [] (const cmaj::ExternalVariable&) -> choc::value::Value { return {}; };
+
+        if (engine.load (errors, program, resolveExternal, {}) && ! errors.hasErrors())
         {
             programDetails = engine.getProgramDetails();
             inputEndpoints = engine.getInputEndpoints();
@@ -1308,7 +1671,7 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
 
     std::shared_ptr<DataListener> createAudioDataListener (const EndpointID& endpointID)
     {
-        auto l = std::make_shared<PatchRenderer::DataListener> (*patch.clientEventQueue);
+        auto l = std::make_shared<PatchRenderer::DataListener> (endpointMonitorTap, *patch.clientEventQueue);
 
         if (auto s = patch.getCustomAudioSourceForInput (endpointID))
         {
@@ -1317,6 +1680,7 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
         }
 
         endpointListeners.add (endpointID, l);
+        endpointMonitorTap.addListener (l);
         return l;
     }
 
@@ -1356,8 +1720,8 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
             {
                 auto monitor = std::make_unique<AudioLevelMonitor> (view, *details, std::move (replyType), granularity, fullData);
 
-                std::lock_guard<decltype(processLock)> lock (processLock);
-                l->audioMonitors.push_back (std::move (monitor));
+                std::lock_guard<decltype(monitorLock)> lock (monitorLock);
+                l->addMonitor (std::move (monitor));
                 return true;
             }
 
@@ -1365,7 +1729,7 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
             {
                 auto monitor = std::make_unique<EndpointListeners::EventMonitor> (view, *details, std::move (replyType));
 
-                std::lock_guard<decltype(processLock)> lock (processLock);
+                std::lock_guard<decltype(monitorLock)> lock (monitorLock);
                 endpointListeners.add (std::move (monitor));
                 return true;
             }
@@ -1376,7 +1740,7 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
 
     bool stopEndpointData (PatchView& view, const EndpointID& e, std::string replyType)
     {
-        std::lock_guard<decltype(processLock)> lock (processLock);
+        std::lock_guard<decltype(monitorLock)> lock (monitorLock);
         return endpointListeners.remove (view, e, replyType);
     }
 
@@ -1501,7 +1865,12 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
     }
 
     void beginProcessBlock()    { processLock.lock(); }
-    void endProcessBlock()      { processLock.unlock(); }
+
+    void endProcessBlock()
+    {
+        endpointMonitorTap.endOfProcessCallback();
+        processLock.unlock();
+    }
 
     //==============================================================================
     bool postParameterChange (const PatchParameterProperties& properties, EndpointHandle endpointHandle,
@@ -1528,18 +1897,14 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
     //==============================================================================
     void processMIDIMessage (choc::midi::ShortMessage message)
     {
-        for (auto& monitor : endpointListeners.eventMonitors)
-            if (monitor->isMIDI)
-                monitor->process (*patch.clientEventQueue, monitor->endpointID, message);
+        if (endpointListeners.hasMIDIMonitors.load (std::memory_order_relaxed))
+            endpointMonitorTap.pushMIDI (choc::span<const choc::midi::ShortMessage> (std::addressof (message), std::addressof (message) + 1));
     }
 
     void processMIDIBlock (const choc::audio::AudioMIDIBlockDispatcher::Block& block)
     {
-        if (! block.midiMessages.empty())
-            for (auto& monitor : endpointListeners.eventMonitors)
-                if (monitor->isMIDI)
-                    for (auto& m : block.midiMessages)
-                        monitor->process (*patch.clientEventQueue, monitor->endpointID, m);
+        if (endpointListeners.hasMIDIMonitors.load (std::memory_order_relaxed))
+            endpointMonitorTap.pushMIDI (block.midiMessages);
     }
 
     //==============================================================================
@@ -1569,7 +1934,7 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
 
     void removeReferencesToView (PatchView& v)
     {
-        std::lock_guard<decltype(processLock)> lock (processLock);
+        std::lock_guard<decltype(monitorLock)> lock (monitorLock);
         endpointListeners.removeReferencesToView (v);
     }
 
@@ -1655,6 +2020,7 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
         void add (std::unique_ptr<EventMonitor> m)
         {
             eventMonitors.push_back (std::move (m));
+            updateMIDIMonitorFlag();
         }
 
         void add (const EndpointID& e, std::shared_ptr<PatchRenderer::DataListener> l)
@@ -1674,12 +2040,19 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
             if (newEnd != oldEnd)
             {
                 eventMonitors.erase (newEnd, oldEnd);
+                updateMIDIMonitorFlag();
                 return true;
             }
 
             return false;
         }
 
+        void updateMIDIMonitorFlag()
+        {
+            hasMIDIMonitors = std::any_of (eventMonitors.begin(), eventMonitors.end(),
+                                           [] (auto& m) { return m->isMIDI; });
+        }
+
         DataListener* findAudioDataListener (const EndpointID& e) const
         {
             if (auto l = dataListeners.find (e.toString()); l != dataListeners.end())
@@ -1705,15 +2078,23 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
             if (newEnd != oldEnd)
                 eventMonitors.erase (newEnd, oldEnd);
 
+            updateMIDIMonitorFlag();
+
             for (auto& d : dataListeners)
                 d.second->removeMonitorsForView (v);
         }
 
         std::unordered_map<std::string, std::shared_ptr<DataListener>> dataListeners;
         std::vector<std::unique_ptr<EventMonitor>> eventMonitors;
+        std::atomic<bool> hasMIDIMonitors { false };
     };
 
     EndpointListeners endpointListeners;
+    EndpointMonitorTap endpointMonitorTap { *this };
+
+    // Protects the monitor lists, which are modified on the message thread and
+    // read by the endpoint monitoring thread.
+    std::mutex monitorLock;
 
 private:
     std::unique_ptr<cmaj::AudioMIDIPerformer> performer;
@@ -1804,20 +2185,23 @@ private:
     {
         BuildTask (BuildThread& o, std::unique_ptr<Build> b) : owner (o), build (std::move (b))
         {
-            thread = std::thread ([this] { run(); });
+            job = JobThreadPool::getSharedBuildPool().addJob ([this] { run(); });
         }
 
         ~BuildTask()
         {
             cancelled = true;
             finished = true;
-            thread.join();
+            job.wait();
         }
 
         void run()
         {
             struct Interrupted {};
 
+            if (cancelled)
+                return;
+
             try
             {
                 build->build ([this]
@@ -1835,7 +2219,7 @@ private:
         BuildThread& owner;
         std::unique_ptr<Build> build;
         std::atomic<bool> cancelled { false }, finished { false };
-        std::thread thread;
+        std::future<void> job;
     };
 
     Patch& owner;
@@ -2580,6 +2964,11 @@ inline Patch::CustomAudioSourcePtr Patch::getCustomAudioSourceForInput (const En
     return {};
 }
 
+inline void Patch::setWorkerThreadPool (std::shared_ptr<RealtimeThreadPool> pool)
+{
+    workerThreadPool = std::move (pool);
+}
+
 inline void Patch::setCustomAudioSourceForInput (const EndpointID& e, Patch::CustomAudioSourcePtr source)
 {
     if (source != nullptr)
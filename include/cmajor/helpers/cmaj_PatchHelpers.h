@@ -36,6 +36,8 @@
 #include "cmaj_EmbeddedWebAssets.h"
 
 #include <algorithm>
+#include <charconv>
+#include <cstring>
 #include <optional>
 #include <unordered_map>
 
@@ -170,9 +172,11 @@ struct PatchManifest
     std::unordered_map<std::string, choc::value::ValueView> getExternalsList() const;
 
     /// Returns a function that can auto-resolve externals for this manifest, using
-    /// the replaceFilenameStringsWithAudioData() helper function. This function
-    /// can be passed straight into the Engine::load() method.
-    std::function<choc::value::Value(const cmaj::ExternalVariable&)> createExternalResolverFunction() const;
+    /// the readManifestResourceAsTensorData() and replaceFilenameStringsWithAudioData()
+    /// helper functions. This function can be passed straight into the Engine::load() method.
+    /// The engine ignores any exceptions that a resolver throws, so if a tensor file can't
+    /// be loaded, the reason is passed to handleError instead.
+    std::function<choc::value::Value(const cmaj::ExternalVariable&)> createExternalResolverFunction (std::function<void(const std::string&)> handleError = {}) const;
 
 private:
     static void addStrings (std::vector<std::string>&, const choc::value::ValueView&);
@@ -270,6 +274,19 @@ choc::value::Value replaceFilenameStringsWithAudioData (const PatchManifest& man
                                                         const choc::value::ValueView& sourceObject,
                                                         const choc::value::ValueView& annotation);
 
+/// Loads a binary file of floating-point data (e.g. the weights for a neural network)
+/// as a value of the given type. The file can be a .npy file containing float32 or float64
+/// data of either byte order, or a headerless .f32 or .f64 file of little-endian values.
+/// The target type must be a float or an array/vector of them (which may be nested).
+/// A .npy file's shape must match the target's dimensions, and a headerless file must
+/// have the same total number of elements. If the target is an unsized array of floats,
+/// it is given all the values from a headerless or one-dimensional .npy file.
+/// Returns a void value if the path doesn't have one of these extensions, and throws a
+/// std::runtime_error describing the problem if the file can't be loaded as the target type.
+choc::value::Value readManifestResourceAsTensorData (const PatchManifest& manifest,
+                                                     const std::string& path,
+                                                     const choc::value::Type& targetType);
+
 std::optional<std::string> readJavascriptResource (std::string_view resourcePath, const PatchManifest*);
 
 //==============================================================================
@@ -719,14 +736,32 @@ inline std::unordered_map<std::string, choc::value::ValueView> PatchManifest::ge
     return result;
 }
 
-inline std::function<choc::value::Value(const cmaj::ExternalVariable&)> PatchManifest::createExternalResolverFunction() const
+inline std::function<choc::value::Value(const cmaj::ExternalVariable&)> PatchManifest::createExternalResolverFunction (std::function<void(const std::string&)> handleError) const
 {
-    return [this, list = getExternalsList()] (const cmaj::ExternalVariable& v) -> choc::value::Value
+    return [this, list = getExternalsList(), handleError] (const cmaj::ExternalVariable& v) -> choc::value::Value
     {
         auto external = list.find (v.name);
 
         if (external != list.end())
+        {
+            if (external->second.isString())
+            {
+                try
+                {
+                    if (auto tensor = readManifestResourceAsTensorData (*this, external->second.get<std::string>(), v.type); ! tensor.isVoid())
+                        return tensor;
+                }
+                catch (const std::exception& e)
+                {
+                    if (handleError)
+                        handleError ("External variable " + v.name + ": " + e.what());
+
+                    return {};
+                }
+            }
+
             return replaceFilenameStringsWithAudioData (*this, external->second, v.annotation);
+        }
 
         return {};
     };
@@ -846,6 +881,219 @@ inline choc::value::Value replaceFilenameStringsWithAudioData (const PatchManife
     return choc::value::Value (v);
 }
 
+inline choc::value::Value readManifestResourceAsTensorData (const PatchManifest& manifest,
+                                                            const std::string& path,
+                                                            const choc::value::Type& targetType)
+{
+    auto extension = choc::text::toLowerCase (std::filesystem::path (path).extension().string());
+
+    if (extension != ".npy" && extension != ".f32" && extension != ".f64")
+        return {};
+
+    auto fail = [&] (const std::string& message)
+    {
+        throw std::runtime_error ("Cannot load \"" + path + "\": " + message);
+    };
+
+    auto content = manifest.readFileContent (path);
+
+    if (! content)
+        fail ("the file could not be opened");
+
+    std::string_view data (*content);
+    bool sourceIsFloat64 = extension == ".f64", sourceIsBigEndian = false;
+    std::optional<std::vector<size_t>> sourceShape;
+
+    if (extension == ".npy")
+    {
+        // The format is a magic string, a version number, a header length and then a
+        // python dictionary literal describing the data, e.g.
+        // {'descr': '<f4', 'fortran_order': False, 'shape': (16, 8), }
+        if (data.length() < 10 || data.substr (0, 6) != "\x93NUMPY")
+            fail ("this is not a valid .npy file");
+
+        auto majorVersion = static_cast<uint8_t> (data[6]);
+        auto readByte = [&] (size_t i) { return static_cast<size_t> (static_cast<uint8_t> (data[i])); };
+
+        size_t headerStart = 10, headerLength = readByte (8) | (readByte (9) << 8);
+
+        if (majorVersion >= 2)
+        {
+            if (data.length() < 12)
+                fail ("this is not a valid .npy file");
+
+            headerStart = 12;
+            headerLength |= (readByte (10) << 16) | (readByte (11) << 24);
+        }
+
+        if (headerStart + headerLength > data.length())
+            fail ("the .npy header is truncated");
+
+        auto header = data.substr (headerStart, headerLength);
+
+        auto findHeaderValue = [&] (std::string_view key) -> std::string_view
+        {
+            auto start = header.find ("'" + std::string (key) + "':");
+
+            if (start == std::string_view::npos)
+                fail ("the .npy header has no '" + std::string (key) + "' entry");
+
+            auto value = choc::text::trimStart (header.substr (start + key.length() + 3));
+
+            if (value.empty())
+                fail ("the .npy header has an invalid '" + std::string (key) + "' entry");
+
+            auto closeBracket = value.front() == '(' ? value.find (')') : std::string_view::npos;
+            return value.substr (0, closeBracket != std::string_view::npos ? closeBracket + 1
+                                                                            : value.find_first_of (",}"));
+        };
+
+        if (findHeaderValue ("fortran_order") != "False")
+            fail ("Fortran-ordered arrays are not supported");
+
+        auto descr = findHeaderValue ("descr");
+
+        if (descr == "'<f4'" || descr == "'>f4'" || descr == "'<f8'" || descr == "'>f8'")
+        {
+            sourceIsBigEndian = descr[1] == '>';
+            sourceIsFloat64 = descr[3] == '8';
+        }
+        else
+        {
+            fail ("the element type " + std::string (descr) + " is not supported (it must be float32 or float64)");
+        }
+
+        auto shapeText = findHeaderValue ("shape");
+
+        if (shapeText.length() < 2 || shapeText.front() != '(' || shapeText.back() != ')')
+            fail ("the .npy header has an invalid shape");
+
+        sourceShape = std::vector<size_t>();
+
+        for (auto& dim : choc::text::splitString (shapeText.substr (1, shapeText.length() - 2), ',', false))
+        {
+            if (auto trimmed = choc::text::trim (dim); ! trimmed.empty())
+            {
+                size_t size = 0;
+                auto end = trimmed.data() + trimmed.length();
+
+                if (auto result = std::from_chars (trimmed.data(), end, size); result.ec != std::errc() || result.ptr != end)
+                    fail ("the .npy header has an invalid shape");
+
+                sourceShape->push_back (size);
+            }
+        }
+
+        data = data.substr (headerStart + headerLength);
+    }
+
+    auto sourceElementSize = sourceIsFloat64 ? sizeof (double) : sizeof (float);
+
+    if (data.length() % sourceElementSize != 0)
+        fail ("the data size is not a multiple of the element size");
+
+    auto numSourceElements = data.length() / sourceElementSize;
+
+    // The bytes are assembled explicitly rather than copied, so that this
+    // works regardless of the byte order of the file or of this machine
+    auto readSourceElement = [&] (size_t index) -> double
+    {
+        auto bytes = reinterpret_cast<const uint8_t*> (data.data()) + index * sourceElementSize;
+        uint64_t bits = 0;
+
+        for (size_t i = 0; i < sourceElementSize; ++i)
+            bits = (bits << 8) | bytes[sourceIsBigEndian ? i : sourceElementSize - 1 - i];
+
+        if (sourceIsFloat64)
+        {
+            double d;
+            std::memcpy (&d, &bits, sizeof (double));
+            return d;
+        }
+
+        auto bits32 = static_cast<uint32_t> (bits);
+        float f;
+        std::memcpy (&f, &bits32, sizeof (float));
+        return f;
+    };
+
+    auto elementType = targetType;
+    std::vector<size_t> targetShape;
+
+    while (elementType.isArray() || elementType.isVector())
+    {
+        if (elementType.isArray() && ! elementType.isUniformArray())
+            fail ("the target type must be a float or an array or vector of floats");
+
+        targetShape.push_back (elementType.getNumElements());
+        elementType = elementType.getElementType();
+    }
+
+    if (! elementType.isFloat())
+        fail ("the target type must be a float or an array or vector of floats");
+
+    auto shapeToString = [] (const std::vector<size_t>& shape)
+    {
+        std::vector<std::string> dims;
+
+        for (auto d : shape)
+            dims.push_back (std::to_string (d));
+
+        return "(" + choc::text::joinStrings (dims, ", ") + ")";
+    };
+
+    if (std::find (targetShape.begin(), targetShape.end(), size_t (0)) != targetShape.end())
+    {
+        if (targetShape.size() != 1)
+            fail ("only a one-dimensional unsized array can be given the size of the file");
+
+        if (sourceShape && sourceShape->size() != 1)
+            fail ("the .npy shape " + shapeToString (*sourceShape) + " must be one-dimensional to fill an unsized array");
+
+        if (elementType.isFloat64())
+            return choc::value::createArray (static_cast<uint32_t> (numSourceElements),
+                                             [&] (uint32_t i) { return readSourceElement (i); });
+
+        return choc::value::createArray (static_cast<uint32_t> (numSourceElements),
+                                         [&] (uint32_t i) { return static_cast<float> (readSourceElement (i)); });
+    }
+
+    if (sourceShape && *sourceShape != targetShape)
+        fail ("the .npy shape " + shapeToString (*sourceShape)
+               + " doesn't match the target dimensions " + shapeToString (targetShape));
+
+    size_t numTargetElements = 1;
+
+    for (auto d : targetShape)
+        numTargetElements *= d;
+
+    if (numTargetElements != numSourceElements)
+        fail ("the file contains " + std::to_string (numSourceElements) + " values, but the target needs "
+               + std::to_string (numTargetElements));
+
+    // The elements of a nested array of floats are packed contiguously, so the
+    // file can be written straight into the value's data, rather than being
+    // added one element at a time
+    choc::value::Value result (targetType);
+    auto dest = static_cast<char*> (const_cast<void*> (static_cast<const void*> (result.getRawData())));
+
+    for (size_t i = 0; i < numSourceElements; ++i)
+    {
+        if (elementType.isFloat64())
+        {
+            auto d = readSourceElement (i);
+            std::memcpy (dest + i * sizeof (double), &d, sizeof (double));
+        }
+        else
+        {
+            auto f = static_cast<float> (readSourceElement (i));
+            std::memcpy (dest + i * sizeof (float), &f, sizeof (float));
+        }
+    }
+
+    return result;
+}
+
 
 //==============================================================================
 inline PatchParameterProperties::PatchParameterProperties (const EndpointDetails& details)
@@ -0,0 +1,404 @@
+//
+//     ,ad888ba,                              88
+//    d8"'    "8b
+//   d8            88,dba,,adba,   ,aPP8A.A8  88     The Cmajor Toolkit
+//   Y8,           88    88    88  88     88  88
+//    Y8a.   .a8P  88    88    88  88,   ,88  88     (C)2024 Cmajor Software Ltd
+//     '"Y888Y"'   88    88    88  '"8bbP"Y8  88     https://cmajor.dev
+//                                           ,88
+//                                        888P"
+//
+//  The Cmajor project is subject to commercial or open-source licensing.
+//  You may use it under the terms of the GPLv3 (see www.gnu.org/licenses), or
+//  visit https://cmajor.dev to learn about our commercial licence options.
+//
+//  CMAJOR IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+//  EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+//  DISCLAIMED.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <functional>
+#include <vector>
+#include <type_traits>
+
+#if defined (__linux__) || defined (__APPLE__)
+ #include <pthread.h>
+ #include <sched.h>
+#endif
+
+#if defined (__x86_64__) || defined (_M_X64) || defined (__i386__) || defined (_M_IX86)
+ #include <immintrin.h>
+#endif
+
+namespace cmaj
+{
+
+//==============================================================================
+/// A fixed set of worker threads that a host can hand to its audio callback, so
+/// that work within a block can be spread across cores.
+///
+/// parallelFor() is safe to call from the audio thread: it doesn't allocate or
+/// take any locks. Idle workers spin for a while before going to sleep, so that
+/// back-to-back blocks don't pay the cost of waking them up, and the calling thread
+/// always takes part in the work, so a batch completes even if no worker wakes in time.
+///
+struct RealtimeThreadPool
+{
+    struct Options
+    {
+        /// The number of extra threads to create - the thread that calls parallelFor()
+        /// also runs tasks, so this is usually one less than the number of cores to use.
+        uint32_t numWorkerThreads = 0;
+
+        /// If non-zero, the workers are given this realtime (SCHED_FIFO) priority.
+        /// This usually needs elevated privileges, and is silently ignored if it fails.
+        int realtimePriority = 0;
+
+        /// If true, each worker is pinned to its own core, starting at firstCoreIndex.
+        bool pinToCores = false;
+        uint32_t firstCoreIndex = 1;
+
+        /// How many times an idle worker polls for new work before sleeping.
+        uint32_t spinIterations = 20000;
+    };
+
+    RealtimeThreadPool (Options);
+    ~RealtimeThreadPool();
+
+    RealtimeThreadPool (const RealtimeThreadPool&) = delete;
+    RealtimeThreadPool& operator= (const RealtimeThreadPool&) = delete;
+
+    uint32_t getNumWorkerThreads() const        { return static_cast<uint32_t> (workers.size()); }
+
+    /// Calls fn (index) for every index from 0 to numTasks - 1, spread across the
+    /// workers and the calling thread, and returns when they've all completed.
+    /// Only one thread may call this at a time.
+    template <typename TaskFn>
+    void parallelFor (uint32_t numTasks, TaskFn&& fn);
+
+private:
+    using TaskCallback = void(*)(void* context, uint32_t index);
+
+    const Options options;
+    std::vector<std::thread> workers;
+
+    // The top 32 bits hold the batch number and the lower 32 the next task index
+    // to be claimed, so a worker that wakes up late can't claim a task from a newer batch
+    std::atomic<uint64_t> batchAndNextTask { 0 };
+    std::atomic<uint32_t> numTasksCompleted { 0 };
+    TaskCallback taskCallback = nullptr;
+    void* taskContext = nullptr;
+    std::atomic<uint32_t> numTasksInBatch { 0 };
+
+    std::atomic<uint32_t> numSleepingWorkers { 0 };
+    std::atomic<bool> shouldExit { false };
+    std::mutex sleepLock;
+    std::condition_variable sleepCondition;
+
+    void runBatch (TaskCallback, void* context, uint32_t numTasks);
+    void workerThread (uint32_t workerIndex);
+    void runAvailableTasks (uint32_t batch);
+    void configureWorkerThread (uint32_t workerIndex);
+
+    static uint32_t getBatch (uint64_t v)       { return static_cast<uint32_t> (v >> 32); }
+
+    static void pause()
+    {
+       #if defined (__x86_64__) || defined (_M_X64) || defined (__i386__) || defined (_M_IX86)
+        _mm_pause();
+       #elif defined (__aarch64__) || defined (__arm64__)
+        __asm__ __volatile__ ("yield");
+       #endif
+    }
+};
+
+//==============================================================================
+/// A simple pool of ordinary-priority threads for running longer, non-realtime jobs
+/// such as builds and test runs.
+struct JobThreadPool
+{
+    /// If growWhenBusy is true, a new thread is started whenever a job is added while
+    /// all the existing ones are occupied, so that jobs never wait behind each other.
+    JobThreadPool (uint32_t numThreads, bool growWhenBusy = false);
+    ~JobThreadPool();
+
+    JobThreadPool (const JobThreadPool&) = delete;
+    JobThreadPool& operator= (const JobThreadPool&) = delete;
+
+    /// Queues a job, returning a future that provides the job's result (or exception)
+    /// once it has finished running.
+    template <typename JobFn>
+    auto addJob (JobFn&& job) -> std::future<std::invoke_result_t<std::decay_t<JobFn>&>>;
+
+    /// Returns a pool that is shared by patch builds. It grows when busy, so a
+    /// build never has to wait for another one to finish before it can start.
+    static JobThreadPool& getSharedBuildPool();
+
+private:
+    const bool growWhenBusy;
+    std::vector<std::thread> threads;
+    std::deque<std::packaged_task<void()>> jobs;
+    std::mutex lock;
+    std::condition_variable jobAdded;
+    uint32_t numIdleThreads = 0;
+    bool shouldExit = false;
+
+    void threadLoop();
+    void addThread();
+};
+
+
+//==============================================================================
+//        _        _           _  _
+//     __| |  ___ | |_   __ _ (_)| | ___
+//    / _` | / _ \| __| / _` || || |/ __|
+//   | (_| ||  __/| |_ | (_| || || |\__ \ _  _  _
+//    \__,_| \___| \__| \__,_||_||_||___/(_)(_)(_)
+//
+//   Code beyond this point is implementation detail...
+//
+//==============================================================================
+
+inline RealtimeThreadPool::RealtimeThreadPool (Options o) : options (o)
+{
+    workers.reserve (options.numWorkerThreads);
+
+    for (uint32_t i = 0; i < options.numWorkerThreads; ++i)
+        workers.emplace_back ([this, i] { workerThread (i); });
+}
+
+inline RealtimeThreadPool::~RealtimeThreadPool()
+{
+    shouldExit = true;
+
+    {
+        std::lock_guard<std::mutex> l (sleepLock);
+        sleepCondition.notify_all();
+    }
+
+    for (auto& w : workers)
+        w.join();
+}
+
+template <typename TaskFn>
+void RealtimeThreadPool::parallelFor (uint32_t numTasks, TaskFn&& fn)
+{
+    runBatch ([] (void* context, uint32_t index) { (*static_cast<std::remove_reference_t<TaskFn>*> (context)) (index); },
+              const_cast<void*> (static_cast<const void*> (std::addressof (fn))), numTasks);
+}
+
+inline void RealtimeThreadPool::runBatch (TaskCallback callback, void* context, uint32_t numTasks)
+{
+    if (numTasks == 0)
+        return;
+
+    if (workers.empty() || numTasks == 1)
+    {
+        for (uint32_t i = 0; i < numTasks; ++i)
+            callback (context, i);
+
+        return;
+    }
+
+    // The previous batch has completed, so no worker can be reading these
+    taskCallback = callback;
+    taskContext = context;
+    numTasksInBatch.store (numTasks, std::memory_order_relaxed);
+    numTasksCompleted.store (0, std::memory_order_relaxed);
+
+    auto batch = getBatch (batchAndNextTask.load (std::memory_order_relaxed)) + 1;
+    batchAndNextTask.store (static_cast<uint64_t> (batch) << 32);
+
+    // Notifying without the lock avoids blocking the audio thread. A worker that misses
+    // this will pick the batch up when its timed wait expires, and meanwhile this thread
+    // runs whatever tasks nobody else has claimed.
+    if (numSleepingWorkers.load() != 0)
+        sleepCondition.notify_all();
+
+    runAvailableTasks (batch);
+
+    while (numTasksCompleted.load (std::memory_order_acquire) != numTasks)
+        pause();
+}
+
+inline void RealtimeThreadPool::runAvailableTasks (uint32_t batch)
+{
+    for (;;)
+    {
+        auto current = batchAndNextTask.load (std::memory_order_acquire);
+
+        if (getBatch (current) != batch)
+            return;
+
+        auto index = static_cast<uint32_t> (current);
+
+        if (index >= numTasksInBatch.load (std::memory_order_relaxed))
+            return;
+
+        // Once a task from this batch is claimed, the batch can't complete (and so its
+        // callback and context can't change) until that task has run
+        if (batchAndNextTask.compare_exchange_weak (current, current + 1, std::memory_order_acq_rel))
+        {
+            taskCallback (taskContext, index);
+            numTasksCompleted.fetch_add (1, std::memory_order_release);
+        }
+    }
+}
+
+inline void RealtimeThreadPool::workerThread (uint32_t workerIndex)
+{
+    configureWorkerThread (workerIndex);
+
+    uint32_t lastBatch = 0;
+
+    while (! shouldExit)
+    {
+        auto hasNewBatch = [&] { return getBatch (batchAndNextTask.load (std::memory_order_acquire)) != lastBatch; };
+
+        bool found = false;
+
+        for (uint32_t i = 0; i < options.spinIterations && ! shouldExit; ++i)
+        {
+            if (hasNewBatch())
+            {
+                found = true;
+                break;
+            }
+
+            pause();
+        }
+
+        if (! found)
+        {
+            std::unique_lock<std::mutex> l (sleepLock);
+            ++numSleepingWorkers;
+
+            while (! (hasNewBatch() || shouldExit))
+                sleepCondition.wait_for (l, std::chrono::milliseconds (5));
+
+            --numSleepingWorkers;
+        }
+
+        if (shouldExit)
+            break;
+
+        lastBatch = getBatch (batchAndNextTask.load (std::memory_order_acquire));
+        runAvailableTasks (lastBatch);
+    }
+}
+
+inline void RealtimeThreadPool::configureWorkerThread ([[maybe_unused]] uint32_t workerIndex)
+{
+   #if defined (__linux__)
+    if (options.pinToCores)
+    {
+        auto numCores = std::thread::hardware_concurrency();
+
+        if (numCores != 0)
+        {
+            cpu_set_t cpuSet;
+            CPU_ZERO (&cpuSet);
+            CPU_SET ((options.firstCoreIndex + workerIndex) % numCores, &cpuSet);
+            pthread_setaffinity_np (pthread_self(), sizeof (cpuSet), &cpuSet);
+        }
+    }
+   #endif
+
+   #if defined (__linux__) || defined (__APPLE__)
+    if (options.realtimePriority > 0)
+    {
+        sched_param param {};
+        param.sched_priority = options.realtimePriority;
+        pthread_setschedparam (pthread_self(), SCHED_FIFO, &param);
+    }
+   #endif
+}
+
+//==============================================================================
+inline JobThreadPool::JobThreadPool (uint32_t numThreads, bool grow) : growWhenBusy (grow)
+{
+    std::lock_guard<std::mutex> l (lock);
+
+    for (uint32_t i = 0; i < std::max (1u, numThreads); ++i)
+        addThread();
+}
+
+inline JobThreadPool::~JobThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> l (lock);
+        shouldExit = true;
+    }
+
+    jobAdded.notify_all();
+
+    for (auto& t : threads)
+        t.join();
+}
+
+template <typename JobFn>
+auto JobThreadPool::addJob (JobFn&& job) -> std::future<std::invoke_result_t<std::decay_t<JobFn>&>>
+{
+    std::packaged_task<std::invoke_result_t<std::decay_t<JobFn>&>()> task (std::forward<JobFn> (job));
+    auto result = task.get_future();
+
+    {
+        std::lock_guard<std::mutex> l (lock);
+        jobs.emplace_back ([t = std::move (task)]() mutable { t(); });
+
+        if (growWhenBusy && numIdleThreads < jobs.size())
+            addThread();
+    }
+
+    jobAdded.notify_one();
+    return result;
+}
+
+inline JobThreadPool& JobThreadPool::getSharedBuildPool()
+{
+    static JobThreadPool pool (1, true);
+    return pool;
+}
+
+inline void JobThreadPool::threadLoop()
+{
+    for (;;)
+    {
+        std::packaged_task<void()> job;
+
+        {
+            std::unique_lock<std::mutex> l (lock);
+            jobAdded.wait (l, [this] { return shouldExit || ! jobs.empty(); });
+
+            if (jobs.empty())
+                return;
+
+            job = std::move (jobs.front());
+            jobs.pop_front();
+            --numIdleThreads;
+        }
+
+        job();
+
+        std::lock_guard<std::mutex> l (lock);
+        ++numIdleThreads;
+    }
+}
+
+inline void JobThreadPool::addThread()
+{
+    // Called with the lock held. A new thread counts as idle from the start, so that
+    // several jobs added before it gets going don't each start another thread.
+    threads.emplace_back ([this] { threadLoop(); });
+    ++numIdleThreads;
+}
+
+} // namespace cmaj
@@ -19,6 +19,9 @@
 #pragma once
 
 #include <unordered_map>
+#include <charconv>
+#include <cstring>
+#include <cerrno>
 #include <unordered_set>
 #include <sstream>
 #include <complex>
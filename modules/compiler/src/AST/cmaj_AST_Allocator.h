@@ -35,7 +35,12 @@ struct Allocator
     }
 
     template <typename Type, typename... Args>
-    Type& allocate (Args&&... args)   { return pool.allocate<Type> (std::forward<Args> (args)...); }
+    Type& allocate (Args&&... args)
+    {
+        ++numObjectsAllocated;
+        numObjectBytesAllocated += sizeof (Type);
+        return pool.allocate<Type> (std::forward<Args> (args)...);
+    }
 
     ObjectContext getContext (CodeLocation location, ptr<Object> parentScope)      { return { *this, location, parentScope }; }
     ObjectContext getContextWithoutLocation (ptr<Object> parentScope)              { return getContext ({}, parentScope); }
@@ -119,10 +124,14 @@ struct Allocator
     }
 
     choc::memory::Pool pool;
+    size_t numObjectsAllocated = 0, numObjectBytesAllocated = 0;
     SourceFileList sourceFileList;
 
     Strings strings { pool };
 
+    /// Returns the number of bytes that objects and pooled strings have taken from the pool.
+    size_t getNumBytesAllocated() const     { return numObjectBytesAllocated + strings.stringPool.getNumBytesAllocated(); }
+
     const PrimitiveType& voidType;
     const PrimitiveType& int32Type;
     const PrimitiveType& int64Type;
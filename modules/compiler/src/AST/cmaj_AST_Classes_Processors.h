@@ -227,6 +227,11 @@ struct ModuleBase  : public Object
                    structures           { *this },
                    enums                { *this },
                    staticAssertions     { *this };
+
+    /// Set on modules that were loaded from the pre-resolved standard library image, and
+    /// cleared as soon as anything modifies them. While it's set, the resolution passes
+    /// can skip the module. This isn't a property, so clones never inherit it.
+    bool isPreResolved = false;
 };
 
 //==============================================================================
@@ -30,6 +30,11 @@ struct Program  : public choc::com::ObjectWithAtomicRefCount<cmaj::ProgramInterf
 
     void parse (const SourceFile&, bool isSystemModule);
 
+    /// Parses a group of files, spreading the work across multiple threads. The modules
+    /// are added in the same order as the files, and if any file fails to parse, the ones
+    /// before it are added and its error is thrown.
+    void parse (const std::vector<const SourceFile*>&, bool isSystemModule);
+
     choc::com::String* parse (const char* filename, const char* fileContent, size_t fileContentSize) override
     {
         return catchAllErrorsAsJSON (false, [&]
@@ -151,10 +156,21 @@ struct Program  : public choc::com::ObjectWithAtomicRefCount<cmaj::ProgramInterf
         return choc::com::createRawString (choc::json::toString (mod->toSyntaxTree (opts), true));
     }
 
+    /// Most programs only use a few of the standard library's namespaces, so the others
+    /// are held back from the tree until a name lookup asks for them. This attaches the
+    /// held-back namespace with the given name, along with any others that it uses, and
+    /// returns false if there wasn't one.
+    bool attachLibraryNamespace (std::string_view name);
+
+    /// Attaches any standard library namespaces that are still being held back, in their
+    /// original order, so that the whole library can be searched.
+    void attachAllLibraryNamespaces();
+
     bool reparse()
     {
         needsReparsing = false;
         rootNamespace.clear();
+        detachedLibraryNamespaces.clear();
         endpointList.clear();
         mainProcessor = {};
 
@@ -162,8 +178,12 @@ struct Program  : public choc::com::ObjectWithAtomicRefCount<cmaj::ProgramInterf
 
         cmaj::catchAllErrors (messageList, [&]
         {
+            std::vector<const SourceFile*> files;
+
             for (auto& sourceFile : allocator.sourceFileList.sourceFiles)
-                parse (*sourceFile, false);
+                files.push_back (sourceFile.get());
+
+            parse (files, false);
         });
 
         return ! messageList.hasErrors();
@@ -242,7 +262,12 @@ private:
     mutable ptr<AST::ProcessorBase> mainProcessor;
     bool needsReparsing = false;
 
+    using LibraryNamespaceDependencies = std::unordered_map<std::string, std::vector<std::string>>;
+    std::vector<ref<AST::Namespace>> detachedLibraryNamespaces;
+
     void addStandardLibraryCode();
+    static const LibraryNamespaceDependencies& getLibraryNamespaceDependencies();
+    static LibraryNamespaceDependencies findLibraryNamespaceDependencies (AST::Namespace&);
 };
 
 static Program& getProgram (cmaj::ProgramInterface& p)
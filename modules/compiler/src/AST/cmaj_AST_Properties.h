@@ -155,9 +155,20 @@ struct StringProperty   : public Property
 
     Property& allocateEmptyCopy (Object& o) const override              { return AST::getAllocator (o).allocate<StringProperty> (o); }
     Property& createClone (Object& o) const override                    { auto& a = AST::getAllocator (o); return a.allocate<StringProperty> (o, a.strings.stringPool.get (value.get())); }
-    void deepCopy (const Property& source, RemappedObjects&) override   { auto s = source.getAsStringProperty(); CMAJ_ASSERT (s != nullptr); value = s->value; }
     choc::value::Value toSyntaxTree (const SyntaxTreeOptions&) override { return choc::value::createString (value); }
 
+    void deepCopy (const Property& source, RemappedObjects&) override
+    {
+        auto s = source.getAsStringProperty();
+        CMAJ_ASSERT (s != nullptr);
+
+        // when cloning into a different allocator, the string needs to come from the new pool
+        if (std::addressof (source.getStringPool()) == std::addressof (getStringPool()))
+            value = s->value;
+        else
+            value = getStringPool().get (s->value.get());
+    }
+
     bool isIdentical (const Property& other) const override
     {
         if (auto o = other.getAsStringProperty())
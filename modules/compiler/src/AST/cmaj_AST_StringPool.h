@@ -50,35 +50,90 @@ struct StringPool
 {
     StringPool (choc::memory::Pool& p) : pool (p)
     {
-        strings.reserve (256);
+        slots.resize (512);
     }
 
-    PooledString get (const std::string& s)
+    PooledString get (std::string_view s)
     {
         if (s.empty())
             return {};
 
-        if (auto i = strings.find (s); i != strings.end())
-            return i->second;
+        auto hash = std::hash<std::string_view>() (s);
+        auto mask = slots.size() - 1;
 
+        for (auto i = hash & mask;; i = (i + 1) & mask)
+        {
+            auto& slot = slots[i];
+
+            if (slot.text == nullptr)
+                break;
+
+            if (slot.hash == hash && *slot.text == s)
+                return PooledString (slot.text);
+        }
+
+        auto ps = PooledString (allocate (s));
+
+        if ((numStrings + 1) * 4 > slots.size() * 3)
+            resize (slots.size() * 2);
+
+        insert ({ hash, ps.text });
+        ++numStrings;
+        return ps;
+    }
+
+    PooledString get (const std::string& s)     { return get (std::string_view (s)); }
+    PooledString get (const char* s)            { return get (std::string_view (s)); }
+
+    size_t getNumBytesAllocated() const         { return numBytesAllocated; }
+
+private:
+    // An open-addressed table of the pooled strings, keyed by the views that live in the
+    // pool itself, so that a lookup never needs to allocate a temporary key. Each slot
+    // keeps its string's hash so that probes and rehashing don't need to recalculate it.
+    struct Slot
+    {
+        size_t hash = 0;
+        const std::string_view* text = nullptr;
+    };
+
+    choc::memory::Pool& pool;
+    std::vector<Slot> slots;
+    size_t numStrings = 0, numBytesAllocated = 0;
+
+    const std::string_view* allocate (std::string_view s)
+    {
         auto length = s.length();
+        numBytesAllocated += sizeof (std::string_view) + length;
         auto data = pool.allocateData (sizeof (std::string_view) + length);
         auto sv = reinterpret_cast<std::string_view*> (data);
         auto text = static_cast<char*> (data) + sizeof (std::string_view);
         new (sv) std::string_view (text, length);
         std::memcpy (text, s.data(), length);
+        return sv;
+    }
 
-        auto ps = PooledString (sv);
-        strings[s] = ps;
-        return ps;
+    void insert (Slot newSlot)
+    {
+        auto mask = slots.size() - 1;
+        auto i = newSlot.hash & mask;
+
+        while (slots[i].text != nullptr)
+            i = (i + 1) & mask;
+
+        slots[i] = newSlot;
     }
 
-    PooledString get (std::string_view s)   { return get (std::string (s)); }
-    PooledString get (const char* s)        { return get (std::string (s)); }
+    void resize (size_t newSize)
+    {
+        auto oldSlots = std::move (slots);
+        slots.clear();
+        slots.resize (newSize);
 
-private:
-    choc::memory::Pool& pool;
-    std::unordered_map<std::string, PooledString> strings;
+        for (auto& slot : oldSlots)
+            if (slot.text != nullptr)
+                insert (slot);
+    }
 };
 
 
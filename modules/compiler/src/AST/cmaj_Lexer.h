@@ -270,12 +270,11 @@ private:
 
             if (isIdentifierStart (firstChar))
             {
-                uint32_t tokenLength = 1;
-                auto tokenEnd = nextCharacter.data();
+                auto tokenEnd = findEndOfIdentifier (nextCharacter.data());
+                auto tokenLength = static_cast<uint32_t> (tokenEnd - nextCharacter.data());
 
-                while (isIdentifierBody (*++tokenEnd))
-                    if (++tokenLength > AST::maxIdentifierLength)
-                        throwError (Errors::identifierTooLong());
+                if (tokenLength > AST::maxIdentifierLength)
+                    throwError (Errors::identifierTooLong());
 
                 if (auto keyword = matchKeyword (tokenLength, nextCharacter))
                 {
@@ -341,6 +340,54 @@ private:
     static constexpr bool isIdentifierStart (char c) noexcept  { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
     static constexpr bool isIdentifierBody  (char c) noexcept  { return isIdentifierStart (c) || (c >= '0' && c <= '9') || c == '_'; }
 
+    struct IdentifierBodyTable
+    {
+        constexpr IdentifierBodyTable()
+        {
+            for (int i = 0; i < 256; ++i)
+                isBody[i] = isIdentifierBody (static_cast<char> (i));
+        }
+
+        bool isBody[256] = {};
+    };
+
+    static const char* findEndOfIdentifier (const char* text) noexcept
+    {
+        static constexpr IdentifierBodyTable table;
+
+        while (table.isBody[static_cast<uint8_t> (*++text)]) {}
+        return text;
+    }
+
+    // Comments can't contain anything that affects where they end, so rather than
+    // decoding the UTF-8, these let the C library scan for the terminator, which it
+    // does a word or vector at a time.
+    static CharPointer findEndOfLineComment (CharPointer start) noexcept
+    {
+        auto text = start.data();
+
+        if (auto newline = std::strchr (text, '\n'))
+            return CharPointer (newline);
+
+        return CharPointer (text + std::strlen (text));
+    }
+
+    static CharPointer findEndOfBlockComment (CharPointer start) noexcept
+    {
+        for (auto text = start.data();;)
+        {
+            auto star = std::strchr (text, '*');
+
+            if (star == nullptr)
+                return CharPointer (text + std::strlen (text));
+
+            if (star[1] == '/')
+                return CharPointer (star);
+
+            text = star + 1;
+        }
+    }
+
     void skipWhitespaceAndComments()
     {
         for (auto t = nextCharacter;;)
@@ -354,7 +401,7 @@ private:
 
                 if (comment.skipIfStartsWith ('/'))
                 {
-                    t = comment.find ("\n");
+                    t = findEndOfLineComment (comment);
 
                     if (! isPreviousCommentConnected (start))
                         previousCommentStart = start;
@@ -366,7 +413,7 @@ private:
                 if (comment.skipIfStartsWith ('*'))
                 {
                     location.text = t;
-                    comment = comment.find ("*/");
+                    comment = findEndOfBlockComment (comment);
                     if (comment.empty()) throwError (Errors::unterminatedComment());
                     t = comment + 2;
                     previousCommentStart = start;
@@ -525,13 +572,41 @@ private:
             return false;
         }
 
-        currentDoubleLiteral = std::stod (std::string (nextCharacter.data(), t.data()));
+        currentDoubleLiteral = parseDouble (nextCharacter.data(), t.data());
         nextCharacter = t;
         currentLiteralType = readFloatLiteralSuffix();
         throwErrorIfInvalidLiteralSuffix (true);
         return true;
     }
 
+    double parseDouble (const char* start, const char* end) const
+    {
+        double result = 0;
+
+       #if defined (__cpp_lib_to_chars)
+        auto parsed = std::from_chars (start, end, result);
+
+        if (parsed.ec == std::errc::result_out_of_range)
+            throwError (Errors::floatLiteralOutOfRange());
+
+        CMAJ_ASSERT (parsed.ec == std::errc() && parsed.ptr == end);
+       #else
+        // Some standard libraries don't yet support from_chars for floating point. The
+        // source text is null-terminated, and readFloat() has already checked the syntax,
+        // so strtod will stop at the same place without needing a copy of the string.
+        char* parsedEnd = nullptr;
+        errno = 0;
+        result = std::strtod (start, std::addressof (parsedEnd));
+
+        if (errno == ERANGE)
+            throwError (Errors::floatLiteralOutOfRange());
+
+        CMAJ_ASSERT (parsedEnd == end);
+       #endif
+
+        return result;
+    }
+
     LexerTokenType readFloatLiteralSuffix()
     {
         if (skipIfStartsWith (nextCharacter, "f32i", "_f32i", "fi"))    return LexerToken::literalImag32;
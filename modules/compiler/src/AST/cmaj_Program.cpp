@@ -24,6 +24,7 @@
 #include "cmaj_Parser.h"
 #include "../standard_library/cmaj_StandardLibrary.h"
 #include "../standard_library/cmaj_StandardLibraryBinary.h"
+#include "../../../include/cmajor/helpers/cmaj_ThreadPools.h"
 
 namespace cmaj
 {
@@ -43,11 +44,238 @@ namespace cmaj
         resetMainProcessor();
     }
 
+    void AST::Program::parse (const std::vector<const SourceFile*>& sources, bool isSystemModule)
+    {
+        if (sources.size() < 2)
+        {
+            for (auto source : sources)
+                parse (*source, isSystemModule);
+
+            return;
+        }
+
+        // The allocator and string pool aren't thread-safe, so each file is parsed into
+        // its own allocator, and the results are then cloned into this program's one
+        struct ParsedFile
+        {
+            ParsedFile() : root (allocator.createNamespace (allocator.strings.rootNamespaceName)) {}
+
+            AST::Allocator allocator;
+            AST::Namespace& root;
+            DiagnosticMessageList messages;
+        };
+
+        std::vector<std::unique_ptr<ParsedFile>> parsedFiles;
+
+        for (size_t i = 0; i < sources.size(); ++i)
+            parsedFiles.push_back (std::make_unique<ParsedFile>());
+
+        {
+            // The pool only lives for the duration of this call, and has no more threads than there are files
+            auto numThreads = std::min (sources.size(), static_cast<size_t> (std::max (1u, std::thread::hardware_concurrency())));
+            JobThreadPool pool (static_cast<uint32_t> (numThreads));
+            std::vector<std::future<void>> jobs;
+
+            for (size_t i = 0; i < sources.size(); ++i)
+            {
+                jobs.push_back (pool.addJob ([&, i]
+                {
+                    auto& parsed = *parsedFiles[i];
+
+                    cmaj::catchAllErrors (parsed.messages, [&]
+                    {
+                        Parser::parseModuleDeclarations (parsed.allocator, *sources[i], isSystemModule,
+                                                         parsingComments, parsed.root, {});
+                    });
+                }));
+            }
+
+            for (auto& job : jobs)
+                job.get();
+        }
+
+        resetMainProcessor();
+
+        for (size_t i = 0; i < sources.size(); ++i)
+        {
+            auto& parsed = parsedFiles[i];
+
+            // A file's own allocator can't find the locations of its messages in this program's
+            // source list, so a file that produced any errors or warnings is parsed again here
+            // to report them properly
+            if (! parsed->messages.empty())
+            {
+                parse (*sources[i], isSystemModule);
+
+                if (parsed->messages.hasErrors())
+                    cmaj::throwError (parsed->messages);
+
+                continue;
+            }
+
+            for (auto& m : parsed->root.getSubModules())
+                rootNamespace.subModules.addChildObject (allocator.createDeepClone (m.get()));
+        }
+
+        transformations::mergeDuplicateNamespaces (rootNamespace);
+    }
+
+    static bool canAttachLibraryNamespaceLazily (const AST::ModuleBase& m)
+    {
+        return m.getAsNamespace() != nullptr
+                && ! m.isGenericOrParameterised()
+                && m.getName() != m.getStrings().intrinsicsNamespaceName;
+    }
+
+    AST::Program::LibraryNamespaceDependencies AST::Program::findLibraryNamespaceDependencies (AST::Namespace& stdNamespace)
+    {
+        // Finds which of the std namespace's children refer to objects inside the other ones
+        struct DependencyFinder  : public AST::Visitor
+        {
+            DependencyFinder (AST::Namespace& ns) : AST::Visitor (ns.context.allocator), stdNamespace (ns) {}
+
+            void visitObject (AST::Object& o) override
+            {
+                if (auto owner = findOwner (o); owner != nullptr && owner.get() != currentOwner.get())
+                {
+                    if (canAttachLibraryNamespaceLazily (*owner))
+                        dependencies.insert (std::string (owner->getName().get()));
+
+                    return;
+                }
+
+                AST::Visitor::visitObject (o);
+            }
+
+            ptr<AST::ModuleBase> findOwner (AST::Object& o) const
+            {
+                for (auto* obj = std::addressof (o); obj != nullptr; obj = obj->getParentScope().get())
+                    if (obj->getParentScope().get() == std::addressof (stdNamespace))
+                        return ptr<AST::ModuleBase> (obj->getAsModuleBase());
+
+                return {};
+            }
+
+            AST::Namespace& stdNamespace;
+            ptr<AST::ModuleBase> currentOwner;
+            std::unordered_set<std::string> dependencies;
+        };
+
+        LibraryNamespaceDependencies result;
+        DependencyFinder finder (stdNamespace);
+
+        for (auto& m : stdNamespace.getSubModules())
+        {
+            finder.currentOwner = m.getPointer();
+            finder.dependencies.clear();
+            finder.visitObject (m.get());
+            result[std::string (m->getName().get())] = std::vector<std::string> (finder.dependencies.begin(), finder.dependencies.end());
+        }
+
+        return result;
+    }
+
+    const AST::Program::LibraryNamespaceDependencies& AST::Program::getLibraryNamespaceDependencies()
+    {
+        // The library's contents never change, so its internal dependencies are found once, from
+        // a private copy of it. A function-level static is only initialised by the first thread
+        // to get here, and any others wait until it's ready.
+        static const auto dependencies = []
+        {
+            AST::Allocator libraryAllocator;
+
+            for (auto& m : transformations::parseBinaryModule (libraryAllocator, standardLibraryData, sizeof (standardLibraryData), false))
+                if (auto ns = m->getAsNamespace(); ns != nullptr && ns->hasName (libraryAllocator.strings.stdLibraryNamespaceName))
+                    return findLibraryNamespaceDependencies (*ns);
+
+            return LibraryNamespaceDependencies();
+        }();
+
+        return dependencies;
+    }
+
     void AST::Program::addStandardLibraryCode()
     {
+        detachedLibraryNamespaces.clear();
+
+        // The binary library was built with the basic resolution passes already applied,
+        // so until something changes them, its modules don't need resolving again
         for (auto& m : transformations::parseBinaryModule (allocator, standardLibraryData, sizeof (standardLibraryData), false))
+        {
+            m->isPreResolved = true;
+
+            if (auto ns = m->getAsNamespace())
+            {
+                ns->visitAllModules (false, [] (AST::ModuleBase& sub) { sub.isPreResolved = true; });
+
+                if (ns->hasName (allocator.strings.stdLibraryNamespaceName))
+                {
+                    for (size_t i = ns->subModules.size(); i > 0; --i)
+                    {
+                        if (auto sub = AST::castTo<AST::Namespace> (ns->subModules[i - 1]); sub != nullptr && canAttachLibraryNamespaceLazily (*sub))
+                        {
+                            detachedLibraryNamespaces.push_back (*sub);
+                            ns->subModules.remove (i - 1);
+                        }
+                    }
+                }
+            }
+
             rootNamespace.subModules.addChildObject (m);
+        }
 
         transformations::mergeDuplicateNamespaces (rootNamespace);
+
+        if (detachedLibraryNamespaces.empty())
+            return;
+
+        // Anything that the permanently-attached parts of the library use, or that the
+        // program's own code adds to, has to be attached straight away
+        auto stdNamespace = rootNamespace.findSystemChildNamespace (allocator.strings.stdLibraryNamespaceName);
+        CMAJ_ASSERT (stdNamespace != nullptr);
+
+        auto& dependencies = getLibraryNamespaceDependencies();
+
+        for (auto& sub : stdNamespace->getSubModules())
+            if (auto deps = dependencies.find (std::string (sub->getName().get())); deps != dependencies.end())
+                for (auto& d : deps->second)
+                    attachLibraryNamespace (d);
+
+        for (auto& sub : stdNamespace->getSubModules())
+            attachLibraryNamespace (sub->getName().get());
+    }
+
+    bool AST::Program::attachLibraryNamespace (std::string_view name)
+    {
+        for (auto i = detachedLibraryNamespaces.begin(); i != detachedLibraryNamespaces.end(); ++i)
+        {
+            if ((*i)->name.get() == name)
+            {
+                auto& ns = i->get();
+                detachedLibraryNamespaces.erase (i);
+
+                auto stdNamespace = rootNamespace.findSystemChildNamespace (allocator.strings.stdLibraryNamespaceName);
+                CMAJ_ASSERT (stdNamespace != nullptr);
+                stdNamespace->subModules.addChildObject (ns);
+
+                auto& dependencies = getLibraryNamespaceDependencies();
+
+                if (auto deps = dependencies.find (std::string (name)); deps != dependencies.end())
+                    for (auto& d : deps->second)
+                        attachLibraryNamespace (d);
+
+                transformations::mergeDuplicateNamespaces (*stdNamespace);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void AST::Program::attachAllLibraryNamespaces()
+    {
+        // The held-back namespaces were collected in reverse order
+        while (! detachedLibraryNamespaces.empty())
+            attachLibraryNamespace (detachedLibraryNamespaces.back()->name.get());
     }
 }
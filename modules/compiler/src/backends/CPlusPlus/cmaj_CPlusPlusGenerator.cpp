@@ -102,7 +102,7 @@ struct CPlusPlusCodeGenerator
            numActiveForwardBranches = 0,
            constantAggregateIndex = 0;
 
-    std::vector<std::string> globalConstants;
+    std::vector<std::string> globalConstants, staticConstantDefinitions;
 
     DuckTypedStructMappings<std::string, true> structTypeNames;
     std::vector<std::string> emittedStructNames;
@@ -160,6 +160,10 @@ struct CPlusPlusCodeGenerator
                 << choc::text::trim (getWarningDisableFlags())
                 << sectionBreak;
 
+            if (hasFunctionsWithOptimisationAnnotations())
+                out << choc::text::trim (getFunctionOptimisationMacros())
+                    << sectionBreak;
+
             Builder codeGen (*this, mainProcessor);
             codeGenerator = codeGen;
 
@@ -187,6 +191,14 @@ struct CPlusPlusCodeGenerator
         }
 
         out << ";" << blankLine;
+
+        if (! staticConstantDefinitions.empty())
+        {
+            for (auto& definition : staticConstantDefinitions)
+                out << definition << newLine;
+
+            out << blankLine;
+        }
     }
 
     void printProcessorDescription()
@@ -1099,7 +1111,12 @@ struct EndpointInfo
                             std::string_view name, ValueReader constantValue)
     {
         CMAJ_ASSERT (! type.isReference());
-        std::string decl = constantValue ? (type.isPrimitive() ? "static constexpr " : "const ") : "";
+
+        if (constantValue && ! type.isPrimitive())
+            return addStaticConstant (getTypeName (type, true), std::string (name), {},
+                                      "{ " + constantValue.getWithoutParens() + " }");
+
+        std::string decl = constantValue ? "static constexpr " : "";
 
         decl += getTypeName (type, true) + " " + std::string (name) + " {";
 
@@ -1111,6 +1128,19 @@ struct EndpointInfo
         globalConstants.push_back (decl);
     }
 
+    /// Aggregate constants are static members, so that all instances of the class share
+    /// one copy of their data rather than each instance holding its own. They're defined
+    /// after the end of the class, because any structs that they contain can't be
+    /// initialised until the class is complete.
+    void addStaticConstant (const std::string& typeName, const std::string& name,
+                            const std::string& arraySuffix, const std::string& initialiser)
+    {
+        globalConstants.push_back ("static const " + typeName + " " + name + arraySuffix + ";");
+
+        auto qualifiedName = mainClassName + "::" + name;
+        staticConstantDefinitions.push_back ("inline decltype (" + qualifiedName + ") " + qualifiedName + " " + initialiser + ";");
+    }
+
     void beginFunction (const AST::Function& fn, std::string_view name, const AST::TypeBase& returnType)
     {
         breakLabelIndex = 0;
@@ -1125,11 +1155,48 @@ struct EndpointInfo
         for (auto& p : fn.iterateParameters())
             args.push_back (getTypeName (*p.getType(), false) + " " + codeGenerator->getVariableName (p));
 
-        out << getTypeName (returnType, false) << " " << name
+        FunctionOptimisationAnnotations annotations (fn);
+
+        out << getFunctionOptimisationAttributes (annotations)
+            << getTypeName (returnType, false) << " " << name
             << ProgramPrinter::createParenthesisedList (args) << " noexcept" << newLine
             << "{" << newLine;
 
         out.addIndent (4);
+
+        if (annotations.useFastMaths)
+            out << (*annotations.useFastMaths ? "CMAJ_FAST_MATHS_SCOPE" : "CMAJ_STRICT_MATHS_SCOPE") << newLine;
+    }
+
+    bool hasFunctionsWithOptimisationAnnotations() const
+    {
+        bool found = false;
+
+        program.visitAllFunctions (true, [&] (const AST::Function& f)
+        {
+            if (FunctionOptimisationAnnotations (f).hasAnnotations())
+                found = true;
+        });
+
+        return found;
+    }
+
+    // The attributes go in front of the function, and are expanded by the macros
+    // from getFunctionOptimisationMacros() into whatever the compiler supports
+    static std::string getFunctionOptimisationAttributes (const FunctionOptimisationAnnotations& annotations)
+    {
+        std::string result;
+
+        if (annotations.optimisationLevel)
+        {
+            auto level = std::min (3, *annotations.optimisationLevel);
+            result += level == 0 ? "CMAJ_NO_OPTIMISATION " : "CMAJ_OPTIMISATION_LEVEL(" + std::to_string (level) + ") ";
+        }
+
+        if (annotations.useFastMaths)
+            result += *annotations.useFastMaths ? "CMAJ_FAST_MATHS_FUNCTION " : "CMAJ_STRICT_MATHS_FUNCTION ";
+
+        return result;
     }
 
     void endFunction()
@@ -1412,10 +1479,9 @@ struct EndpointInfo
         if (elements.size() > 32 && type.isArray())
         {
             auto rawArrayName = getNextConstantName();
-            auto rawArrayDecl = "const " + getTypeName (*type.getArrayOrVectorElementType(), true) + " " + rawArrayName
-                                  + "[" + std::to_string (elements.size()) + "] = { " + elementDecl + " };";
 
-            globalConstants.push_back (rawArrayDecl);
+            addStaticConstant (getTypeName (*type.getArrayOrVectorElementType(), true), rawArrayName,
+                               "[" + std::to_string (elements.size()) + "]", "= { " + elementDecl + " }");
 
             elementDecl = rawArrayName + ", " + std::to_string (elements.size()) + "u";
         }
@@ -1423,8 +1489,7 @@ struct EndpointInfo
         if (mustHaveAddress)
         {
             auto name = getNextConstantName();
-            auto decl = "const " + typeName + " " + name + " = { " + elementDecl + " };";
-            globalConstants.push_back (decl);
+            addStaticConstant (typeName, name, {}, "= { " + elementDecl + " }");
             return createReaderNoParensNeeded (name);
         }
 
@@ -1907,6 +1972,36 @@ struct Slice
 )CPPGEN";
     }
 
+    static std::string_view getFunctionOptimisationMacros()
+    {
+        return R"CPPGEN(
+#ifndef CMAJ_NO_OPTIMISATION
+ #if __clang__
+  #define CMAJ_NO_OPTIMISATION              __attribute__((optnone))
+  #define CMAJ_OPTIMISATION_LEVEL(level)
+  #define CMAJ_FAST_MATHS_FUNCTION
+  #define CMAJ_STRICT_MATHS_FUNCTION
+  #define CMAJ_FAST_MATHS_SCOPE             _Pragma ("clang fp reassociate(on) contract(fast)")
+  #define CMAJ_STRICT_MATHS_SCOPE           _Pragma ("clang fp reassociate(off) contract(on)")
+ #elif __GNUC__
+  #define CMAJ_NO_OPTIMISATION              __attribute__((optimize ("O0")))
+  #define CMAJ_OPTIMISATION_LEVEL(level)    __attribute__((optimize ("O" #level)))
+  #define CMAJ_FAST_MATHS_FUNCTION          __attribute__((optimize ("fast-math")))
+  #define CMAJ_STRICT_MATHS_FUNCTION        __attribute__((optimize ("no-fast-math")))
+  #define CMAJ_FAST_MATHS_SCOPE
+  #define CMAJ_STRICT_MATHS_SCOPE
+ #else
+  #define CMAJ_NO_OPTIMISATION
+  #define CMAJ_OPTIMISATION_LEVEL(level)
+  #define CMAJ_FAST_MATHS_FUNCTION
+  #define CMAJ_STRICT_MATHS_FUNCTION
+  #define CMAJ_FAST_MATHS_SCOPE
+  #define CMAJ_STRICT_MATHS_SCOPE
+ #endif
+#endif
+)CPPGEN";
+    }
+
     static std::string_view getWarningReenableFlags()
     {
         return R"CPPGEN(
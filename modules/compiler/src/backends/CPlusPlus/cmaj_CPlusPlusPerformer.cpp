@@ -155,6 +155,12 @@ struct CPlusPlusEngine
     static constexpr bool supportsExternalFunctions = false;
     static bool engineSupportsIntrinsic (AST::Intrinsic::Type) { return true; }
 
+    /// The generated class stores vectors as arrays, so they aren't over-aligned
+    static choc::value::Value createStateLayoutReport (const AST::Program& program)
+    {
+        return transformations::createStateLayoutReport (program, [] (const AST::TypeBase& t) { return transformations::getNaturalTypeLayout (t, false); });
+    }
+
     //==============================================================================
     struct LinkedCode
     {
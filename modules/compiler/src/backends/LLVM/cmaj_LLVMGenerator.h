@@ -21,10 +21,94 @@
 #include "choc/memory/choc_Endianness.h"
 #include "../../codegen/cmaj_CodeGenHelpers.h"
 #include "../../validation/cmaj_ValidationUtilities.h"
+#include "../../diagnostics/cmaj_CompileProfiler.h"
 
 namespace cmaj::llvm
 {
 
+//==============================================================================
+/// The CPU and instruction-set features selected by the simdTarget build setting.
+/// If the setting is empty (or "native"), the cpu is left empty and the host's own
+/// CPU and features are used.
+struct SIMDTarget
+{
+    SIMDTarget() = default;
+
+    SIMDTarget (const BuildSettings& buildSettings, const ::llvm::Triple& triple)
+        : name (buildSettings.getSIMDTarget())
+    {
+        if (name.empty() || name == "native")
+            return;
+
+        if (name == "sse2" || name == "avx2" || name == "avx512")
+        {
+            if (triple.getArch() != ::llvm::Triple::x86_64)
+                throwError (Errors::simdTargetNotAvailable (name, triple.getArchName().str()));
+
+            if (name == "sse2")     set ("x86-64",    { "+sse2" }, 128);
+            if (name == "avx2")     set ("x86-64-v3", { "+avx2", "+fma" }, 256);
+            if (name == "avx512")   set ("x86-64-v4", { "+avx512f", "+avx512dq", "+avx512vl", "+avx512bw" }, 512);
+            return;
+        }
+
+        if (name == "neon")
+        {
+            if (! (triple.isAArch64() || triple.isARM()))
+                throwError (Errors::simdTargetNotAvailable (name, triple.getArchName().str()));
+
+            set ("generic", { "+neon" }, 128);
+            return;
+        }
+
+        throwError (Errors::unknownSIMDTarget (name));
+    }
+
+    std::string name, cpu;
+    std::vector<std::string> features;
+    uint32_t vectorWidthBits = 0;
+
+    bool isHostDefault() const      { return cpu.empty(); }
+
+    /// Replaces the CPU and features that a JITTargetMachineBuilder has detected. If the
+    /// code is going to run on this machine, it first checks that the CPU supports them.
+    void applyTo (::llvm::orc::JITTargetMachineBuilder& builder, bool willRunOnHost) const
+    {
+        if (isHostDefault())
+            return;
+
+        if (willRunOnHost)
+        {
+            auto hostFeatures = builder.getFeatures().getFeatures();
+
+            // an empty list means that the host features couldn't be detected
+            if (! hostFeatures.empty())
+                for (auto& f : features)
+                    if (std::find (hostFeatures.begin(), hostFeatures.end(), f) == hostFeatures.end())
+                        throwError (Errors::simdTargetNotSupportedByCPU (name));
+        }
+
+        builder.setCPU (cpu);
+        builder.getFeatures() = ::llvm::SubtargetFeatures();
+        builder.addFeatures (features);
+    }
+
+    /// Creates a target machine for the given triple, using this CPU and features, or the
+    /// triple's default CPU if no SIMD target was chosen.
+    std::unique_ptr<::llvm::TargetMachine> createTargetMachine (const ::llvm::Triple& triple) const
+    {
+        ::llvm::SmallVector<std::string, 16> attributes (features.begin(), features.end());
+        return std::unique_ptr<::llvm::TargetMachine> (::llvm::EngineBuilder().selectTarget (triple, {}, cpu, attributes));
+    }
+
+private:
+    void set (std::string cpuName, std::vector<std::string> cpuFeatures, uint32_t widthBits)
+    {
+        cpu = std::move (cpuName);
+        features = std::move (cpuFeatures);
+        vectorWidthBits = widthBits;
+    }
+};
+
 //==============================================================================
 struct LLVMCodeGenerator
 {
@@ -51,6 +135,9 @@ struct LLVMCodeGenerator
 
         useFastMaths = buildSettings.shouldUseFastMaths();
 
+        if (! webAssemblyMode)
+            simdTarget = SIMDTarget (buildSettings, ::llvm::Triple (targetTriple));
+
         auto& mainProcessor = program.getMainProcessor();
 
         stateStruct = mainProcessor.findStruct (mainProcessor.getStrings().stateStructName);
@@ -79,9 +166,12 @@ struct LLVMCodeGenerator
         CodeGenerator<LLVMCodeGenerator> codeGen (*this, program.getMainProcessor());
         codeGenerator = codeGen;
 
-        codeGen.emitTypes();
-        codeGen.emitGlobals();
-        codeGen.emitFunctions();
+        {
+            CompileProfiler::Scope profilerScope ("LLVM IR generation", "llvm");
+            codeGen.emitTypes();
+            codeGen.emitGlobals();
+            codeGen.emitFunctions();
+        }
 
        #if CMAJ_LLVM_RUN_VERIFIER
         if (verifyModule (*targetModule))
@@ -212,6 +302,8 @@ struct LLVMCodeGenerator
     ptr<AST::StructType> stateStruct, ioStruct;
     ptr<CodeGenerator<LLVMCodeGenerator>> codeGenerator;
     bool useFastMaths = false;
+    int highestAnnotatedOptimisationLevel = 0;
+    SIMDTarget simdTarget;
 
     ::llvm::DataLayout dataLayout;
     choc::value::SimpleStringDictionary& stringDictionary;
@@ -357,6 +449,7 @@ struct LLVMCodeGenerator
                 opts.setFPDenormalMode (::llvm::DenormalMode::getPositiveZero());
 
                 machineBuilder->setCodeGenOptLevel (getCodeGenOptLevel (buildSettings.getOptimisationLevel()));
+                simdTarget.applyTo (*machineBuilder, false);
 
                 if (auto tm = machineBuilder->createTargetMachine())
                     targetMachine = std::move (tm.get());
@@ -374,7 +467,9 @@ struct LLVMCodeGenerator
 
     void applyOptimisationPasses()
     {
-        auto optLevel = getOptimisationLevelWithDefault (buildSettings.getOptimisationLevel());
+        CompileProfiler::Scope profilerScope ("LLVM optimisation", "llvm");
+        auto optLevel = std::max (getOptimisationLevelWithDefault (buildSettings.getOptimisationLevel()),
+                                  highestAnnotatedOptimisationLevel);
 
         ::llvm::LoopAnalysisManager     loopAnalysisManager;
         ::llvm::FunctionAnalysisManager functionAnalysisManager;
@@ -383,7 +478,40 @@ struct LLVMCodeGenerator
 
         functionAnalysisManager.registerPass ([&] { return ::llvm::AAManager(); });
 
-        ::llvm::PassBuilder passBuilder;
+        ::llvm::PassInstrumentationCallbacks instrumentationCallbacks;
+        std::vector<size_t> runningPassEvents;
+
+        if (auto profiler = CompileProfiler::getActive())
+        {
+            // Only the top-level stages of the pipeline are recorded, because the passes
+            // nested inside them run once for every function
+            instrumentationCallbacks.registerBeforeNonSkippedPassCallback ([profiler, &runningPassEvents] (::llvm::StringRef passID, ::llvm::Any)
+            {
+                runningPassEvents.push_back (runningPassEvents.empty() ? profiler->beginEvent (std::string_view (passID.data(), passID.size()), "llvm")
+                                                                       : CompileProfiler::noEvent);
+            });
+
+            auto endPass = [profiler, &runningPassEvents]
+            {
+                if (! runningPassEvents.empty())
+                {
+                    profiler->endEvent (runningPassEvents.back());
+                    runningPassEvents.pop_back();
+                }
+            };
+
+            instrumentationCallbacks.registerAfterPassCallback ([endPass] (::llvm::StringRef, ::llvm::Any, const ::llvm::PreservedAnalyses&) { endPass(); });
+            instrumentationCallbacks.registerAfterPassInvalidatedCallback ([endPass] (::llvm::StringRef, const ::llvm::PreservedAnalyses&) { endPass(); });
+        }
+
+        // When a SIMD target has been chosen, the optimiser is given a target machine, so
+        // that the vectorisers know which instructions and register widths they can use
+        std::unique_ptr<::llvm::TargetMachine> targetMachine;
+
+        if (! simdTarget.isHostDefault())
+            targetMachine = simdTarget.createTargetMachine (::llvm::Triple (targetModule->getTargetTriple()));
+
+        ::llvm::PassBuilder passBuilder (targetMachine.get(), {}, {}, std::addressof (instrumentationCallbacks));
 
         passBuilder.registerLoopAnalyses     (loopAnalysisManager);
         passBuilder.registerFunctionAnalyses (functionAnalysisManager);
@@ -865,6 +993,33 @@ struct LLVMCodeGenerator
         {
             currentFunction->addFnAttr ("wasm-export-name", currentFunction->getName());
         }
+
+        if (simdTarget.vectorWidthBits != 0)
+            currentFunction->addFnAttr ("prefer-vector-width", std::to_string (simdTarget.vectorWidthBits));
+    }
+
+    // LLVM runs a single pass pipeline over the whole module, so an [[ optimise ]] level
+    // can only raise the level for the module, or disable optimisation for a function
+    void applyFunctionOptimisationAttributes (const FunctionOptimisationAnnotations& annotations)
+    {
+        if (annotations.optimisationLevel)
+        {
+            auto level = getOptimisationLevelWithDefault (*annotations.optimisationLevel);
+            highestAnnotatedOptimisationLevel = std::max (highestAnnotatedOptimisationLevel, level);
+
+            if (level == 0)
+            {
+                currentFunction->addFnAttr (::llvm::Attribute::AttrKind::OptimizeNone);
+                currentFunction->addFnAttr (::llvm::Attribute::AttrKind::NoInline);
+            }
+        }
+
+        if (useFastMaths)
+        {
+            for (auto attribute : { "unsafe-fp-math", "no-nans-fp-math", "no-infs-fp-math",
+                                    "no-signed-zeros-fp-math", "approx-func-fp-math" })
+                currentFunction->addFnAttr (attribute, "true");
+        }
     }
 
     void beginFunction (const AST::Function& fn, std::string_view, const AST::TypeBase&)
@@ -872,8 +1027,14 @@ struct LLVMCodeGenerator
         localVariables.clear();
         CMAJ_ASSERT (currentFunction == nullptr && currentBlock == nullptr);
 
+        FunctionOptimisationAnnotations annotations (fn);
+        useFastMaths = annotations.shouldUseFastMaths (buildSettings.shouldUseFastMaths());
+
         startNewFunction (getOrAddFunction (fn), isExportedFunction (fn));
 
+        if (annotations.hasAnnotations())
+            applyFunctionOptimisationAttributes (annotations);
+
         functionEntryBlockBuilder = std::make_unique<::llvm::IRBuilder<>> (createBlock());
         functionStartBlock = createBlock();
         setCurrentBlock (functionStartBlock);
@@ -1567,6 +1728,36 @@ struct LLVMCodeGenerator
         return makeReader (getBlockBuilder().CreateSelect (args[0], args[1], args[2]), returnType);
     }
 
+    ValueReader createIntrinsic_minOrMax (::llvm::ArrayRef<::llvm::Value*> args, const AST::TypeBase& returnType, bool isMin)
+    {
+        if (! webAssemblyMode)
+            return createIntrinsicCall (isMin ? ::llvm::Intrinsic::minnum : ::llvm::Intrinsic::maxnum, args, returnType);
+
+        if (! returnType.isFloatOrVectorOfFloat())
+            return {};
+
+        // WASM has no instructions that match minnum/maxnum, so this uses the same compare
+        // and select as the library functions, which works on whole vectors
+        auto& b = getBlockBuilder();
+        auto comparison = b.CreateFCmp (isMin ? ::llvm::CmpInst::Predicate::FCMP_OLT
+                                              : ::llvm::CmpInst::Predicate::FCMP_OGT, args[0], args[1]);
+
+        return makeReader (b.CreateSelect (comparison, args[0], args[1]), returnType);
+    }
+
+    ValueReader createIntrinsic_tan (::llvm::ArrayRef<::llvm::Value*> args, const AST::TypeBase& returnType)
+    {
+        // There's no llvm intrinsic for tan, but using sin / cos (as the library does) means
+        // that vectors are handled in one go, rather than an element at a time
+        if (webAssemblyMode || ! returnType.isFloatOrVectorOfFloat())
+            return {};
+
+        auto sin = createIntrinsicCall (::llvm::Intrinsic::sin, args, returnType);
+        auto cos = createIntrinsicCall (::llvm::Intrinsic::cos, args, returnType);
+
+        return makeReader (getBlockBuilder().CreateFDiv (dereference (sin), dereference (cos)), returnType);
+    }
+
     ValueReader createIntrinsicCall (::llvm::Intrinsic::ID intrinsicID, ::llvm::ArrayRef<::llvm::Value*> args, const AST::TypeBase& returnType)
     {
         if (! returnType.isFloatOrVectorOfFloat())
@@ -1596,8 +1787,8 @@ struct LLVMCodeGenerator
         switch (intrinsic)
         {
             case AST::Intrinsic::Type::abs:           return createIntrinsicCall (::llvm::Intrinsic::fabs,   args, returnType);
-            case AST::Intrinsic::Type::min:           return webAssemblyMode ? ValueReader() : createIntrinsicCall (::llvm::Intrinsic::minnum, args, returnType);
-            case AST::Intrinsic::Type::max:           return webAssemblyMode ? ValueReader() : createIntrinsicCall (::llvm::Intrinsic::maxnum, args, returnType);
+            case AST::Intrinsic::Type::min:           return createIntrinsic_minOrMax (args, returnType, true);
+            case AST::Intrinsic::Type::max:           return createIntrinsic_minOrMax (args, returnType, false);
             case AST::Intrinsic::Type::floor:         return createIntrinsicCall (::llvm::Intrinsic::floor,  args, returnType);
             case AST::Intrinsic::Type::ceil:          return createIntrinsicCall (::llvm::Intrinsic::ceil,   args, returnType);
             case AST::Intrinsic::Type::rint:          return createIntrinsicCall (::llvm::Intrinsic::rint,   args, returnType);
@@ -1608,6 +1799,7 @@ struct LLVMCodeGenerator
             case AST::Intrinsic::Type::pow:           return createIntrinsicCall (::llvm::Intrinsic::pow,    args, returnType);
             case AST::Intrinsic::Type::sin:           return createIntrinsicCall (::llvm::Intrinsic::sin,    args, returnType);
             case AST::Intrinsic::Type::cos:           return createIntrinsicCall (::llvm::Intrinsic::cos,    args, returnType);
+            case AST::Intrinsic::Type::tan:           return createIntrinsic_tan (args, returnType);
             case AST::Intrinsic::Type::isnan:         return createIntrinsic_isNanOrInf (args.front(), true);
             case AST::Intrinsic::Type::isinf:         return createIntrinsic_isNanOrInf (args.front(), false);
             case AST::Intrinsic::Type::reinterpretFloatToInt:  return createIntrinsic_reinterpretFloatToInt (args.front());
@@ -1616,7 +1808,6 @@ struct LLVMCodeGenerator
             case AST::Intrinsic::Type::select:        return createIntrinsic_select (args, returnType);
 
             case AST::Intrinsic::Type::fmod:
-            case AST::Intrinsic::Type::tan:
             case AST::Intrinsic::Type::addModulo2Pi:
             case AST::Intrinsic::Type::remainder:
             case AST::Intrinsic::Type::clamp:
@@ -84,7 +84,7 @@ static void initialiseLLVM()
 
 struct LLJITHolder
 {
-    LLJITHolder (int optimisationLevel)
+    LLJITHolder (const BuildSettings& buildSettings)
     {
         ::llvm::sys::DynamicLibrary::LoadLibraryPermanently (nullptr);
 
@@ -96,7 +96,8 @@ struct LLJITHolder
             opts.setFPDenormalMode (::llvm::DenormalMode::getPositiveZero());
             opts.setFP32DenormalMode (::llvm::DenormalMode::getPositiveZero());
 
-            machineBuilder->setCodeGenOptLevel (getCodeGenOptLevel (optimisationLevel));
+            machineBuilder->setCodeGenOptLevel (getCodeGenOptLevel (buildSettings.getOptimisationLevel()));
+            SIMDTarget (buildSettings, targetTriple).applyTo (*machineBuilder, true);
 
             ::llvm::orc::LLJITBuilder builder;
             builder.setJITTargetMachineBuilder (machineBuilder.get());
@@ -211,6 +212,26 @@ struct LLVMEngine
     static constexpr bool supportsExternalFunctions = true;
     static bool engineSupportsIntrinsic (AST::Intrinsic::Type) { return true; }
 
+    /// Takes the layout from the same data layout that the JIT will use when linking
+    choc::value::Value createStateLayoutReport (const AST::Program& program)
+    {
+        LLJITHolder lljit (engine.buildSettings);
+        choc::value::SimpleStringDictionary stringDictionary;
+
+        LLVMCodeGenerator codeGen (program, engine.options, engine.buildSettings,
+                                   lljit.getTargetTriple(), lljit.getDataLayout(),
+                                   stringDictionary, false);
+
+        return transformations::createStateLayoutReport (program, [&] (const AST::TypeBase& t) -> transformations::TypeSizeAndAlignment
+        {
+            auto type = codeGen.getLLVMType (t);
+            auto& dataLayout = lljit.getDataLayout();
+
+            return { static_cast<uint64_t> (dataLayout.getTypeAllocSize (type)),
+                     static_cast<uint64_t> (dataLayout.getABITypeAlign (type).value()) };
+        });
+    }
+
     using InitialiseFn       = void*(*)(void*, int32_t*, int32_t, double);
     using AdvanceOneFrameFn  = void(*)(void*, void*);
     using AdvanceBlockFn     = void(*)(void*, void*, uint32_t);
@@ -221,7 +242,7 @@ struct LLVMEngine
     {
         LinkedCode (LLVMEngine& llvmEngine, bool isSingleFrameOnly, double latencyToUse,
                     CacheDatabaseInterface* cache, const char* cacheKey)
-           : lljit (llvmEngine.engine.buildSettings.getOptimisationLevel()),
+           : lljit (llvmEngine.engine.buildSettings),
              latency (latencyToUse)
         {
             LLVMCodeGenerator codeGen (*llvmEngine.engine.program,
@@ -256,6 +277,7 @@ struct LLVMEngine
             if (cache != nullptr && ! loadedFromCache)
                 codeGen.saveBitcodeToCache (*cache, cacheKey);
 
+            CompileProfiler::Scope profilerScope ("LLVM JIT compilation", "llvm");
             lljit.addExternalFunctionSymbols (codeGen.externalFunctionPointers);
             lljit.load (codeGen.takeCompiledModule());
 
@@ -268,6 +290,11 @@ struct LLVMEngine
 
             for (auto& e : inputValues)
                 loadFunction (e.setValue, e.setValueFnName);
+
+            for (auto& e : inputEvents)
+                for (auto& h : e.eventTypeHandlers)
+                    if (! h.functionName.empty())
+                        h.function = lljit.findSymbol (h.functionName);
         }
 
         //==============================================================================
@@ -300,6 +327,20 @@ struct LLVMEngine
             SetValueRampFn setValue = {};
         };
 
+        struct InputEventEndpoint
+        {
+            EndpointHandle handle;
+
+            struct EventTypeHandler
+            {
+                std::string functionName;
+                void* function = nullptr;
+                ptr<const NativeTypeLayout> layout;
+            };
+
+            std::vector<EventTypeHandler> eventTypeHandlers;
+        };
+
         struct OutputStreamEndpoint
         {
             EndpointHandle handle;
@@ -331,6 +372,7 @@ struct LLVMEngine
 
         std::vector<InputStreamEndpoint>  inputStreams;
         std::vector<InputValueEndpoint>   inputValues;
+        std::vector<InputEventEndpoint>   inputEvents;
         std::vector<OutputStreamEndpoint> outputStreams;
         std::vector<OutputValueEndpoint>  outputValues;
         std::vector<OutputEventEndpoint>  outputEvents;
@@ -364,7 +406,7 @@ struct LLVMEngine
                 {
                     if (endpoint.details.isStream())
                     {
-                        auto& frameType = endpoint.endpoint.getSingleDataType();
+                        auto& frameType = endpoint.endpoint->getSingleDataType();
 
                         inputStreams.push_back ({ handle,
                                                   codeGen.getStructMemberOffset (*codeGen.ioStruct, endpointID),
@@ -375,22 +417,26 @@ struct LLVMEngine
                     else if (endpoint.details.isValue())
                     {
                         inputValues.push_back ({ handle,
-                                                 codeGen.getPaddedTypeSize (endpoint.endpoint.getSingleDataType()),
-                                                 nativeTypeLayouts.get (endpoint.endpoint.getSingleDataType()),
-                                                 AST::getSetValueFunctionName (endpoint.endpoint),
+                                                 codeGen.getPaddedTypeSize (endpoint.endpoint->getSingleDataType()),
+                                                 nativeTypeLayouts.get (endpoint.endpoint->getSingleDataType()),
+                                                 AST::getSetValueFunctionName (*endpoint.endpoint),
                                                  nullptr });
                     }
                     else if (endpoint.details.isEvent())
                     {
-                        for (auto& dataType : endpoint.endpoint.getDataTypes())
-                            nativeTypeLayouts.get (dataType);
+                        auto handlerNames = getEventHandlerFunctionNames (endpoint, "_sendEvent_");
+                        auto dataTypes = endpoint.endpoint->getDataTypes();
+                        inputEvents.push_back ({ handle, {} });
+
+                        for (size_t i = 0; i < dataTypes.size(); ++i)
+                            inputEvents.back().eventTypeHandlers.push_back ({ handlerNames[i], nullptr, nativeTypeLayouts.get (dataTypes[i]) });
                     }
                 }
                 else
                 {
                     if (endpoint.details.isStream())
                     {
-                        auto& frameType = endpoint.endpoint.getSingleDataType();
+                        auto& frameType = endpoint.endpoint->getSingleDataType();
 
                         outputStreams.push_back ({ handle,
                                                    codeGen.getStructMemberOffset (*codeGen.ioStruct, endpointID),
@@ -402,7 +448,7 @@ struct LLVMEngine
                     {
                         outputValues.push_back ({ handle,
                                                   codeGen.getStructMemberOffset (*codeGen.stateStruct, StreamUtilities::getValueEndpointStructMemberName (endpointID)),
-                                                  nativeTypeLayouts.get (endpoint.endpoint.getSingleDataType()) });
+                                                  nativeTypeLayouts.get (endpoint.endpoint->getSingleDataType()) });
                     }
                     else if (endpoint.details.isEvent())
                     {
@@ -597,24 +643,30 @@ struct LLVMEngine
             };
         }
 
-        std::function<void(const void*)> createSendEventFunction (const EndpointInfo&, const AST::TypeBase& type, const AST::Function& f)
+        std::function<void(const void*)> createSendEventFunction (const EndpointInfo& e, uint32_t typeIndex)
         {
-            auto eventType = type.toChocType();
-            auto name = AST::getEventHandlerFunctionName (f);
-            auto state = statePointer;
+            auto& info = code->getEndpointInfo (code->inputEvents, e.handle);
+            CMAJ_ASSERT (typeIndex < info.eventTypeHandlers.size());
+            auto& handler = info.eventTypeHandlers[typeIndex];
+            auto call = handler.function;
+
+            if (handler.functionName.empty())
+                return {};
 
-            void* call = code->lljit.findSymbol (name);
             CMAJ_ASSERT (call != nullptr);
 
-            if (type.isVoid())              return [call, state] (const void*)      { using F = void(*)(void*);           reinterpret_cast<F> (call) (state); };
-            if (type.isPrimitiveInt32())    return [call, state] (const void* data) { using F = void(*)(void*, int32_t);  reinterpret_cast<F> (call) (state, *static_cast<const int32_t*>  (data)); };
-            if (type.isPrimitiveInt64())    return [call, state] (const void* data) { using F = void(*)(void*, int64_t);  reinterpret_cast<F> (call) (state, *static_cast<const int64_t*>  (data)); };
-            if (type.isPrimitiveFloat32())  return [call, state] (const void* data) { using F = void(*)(void*, float);    reinterpret_cast<F> (call) (state, *static_cast<const float*>    (data)); };
-            if (type.isPrimitiveFloat64())  return [call, state] (const void* data) { using F = void(*)(void*, double);   reinterpret_cast<F> (call) (state, *static_cast<const double*>   (data)); };
-            if (type.isPrimitiveBool())     return [call, state] (const void* data) { using F = void(*)(void*, int32_t);  reinterpret_cast<F> (call) (state, *static_cast<const int32_t*>  (data)); };
-            if (type.isPrimitiveString())   return [call, state] (const void* data) { using F = void(*)(void*, uint32_t); reinterpret_cast<F> (call) (state, *static_cast<const uint32_t*> (data)); };
+            auto& type = e.details.dataTypes[typeIndex];
+            auto state = statePointer;
+
+            if (type.isVoid())      return [call, state] (const void*)      { using F = void(*)(void*);           reinterpret_cast<F> (call) (state); };
+            if (type.isInt32())     return [call, state] (const void* data) { using F = void(*)(void*, int32_t);  reinterpret_cast<F> (call) (state, *static_cast<const int32_t*>  (data)); };
+            if (type.isInt64())     return [call, state] (const void* data) { using F = void(*)(void*, int64_t);  reinterpret_cast<F> (call) (state, *static_cast<const int64_t*>  (data)); };
+            if (type.isFloat32())   return [call, state] (const void* data) { using F = void(*)(void*, float);    reinterpret_cast<F> (call) (state, *static_cast<const float*>    (data)); };
+            if (type.isFloat64())   return [call, state] (const void* data) { using F = void(*)(void*, double);   reinterpret_cast<F> (call) (state, *static_cast<const double*>   (data)); };
+            if (type.isBool())      return [call, state] (const void* data) { using F = void(*)(void*, int32_t);  reinterpret_cast<F> (call) (state, *static_cast<const int32_t*>  (data)); };
+            if (type.isString())    return [call, state] (const void* data) { using F = void(*)(void*, uint32_t); reinterpret_cast<F> (call) (state, *static_cast<const uint32_t*> (data)); };
 
-            auto& layout = *code->nativeTypeLayouts.find (type);
+            auto& layout = *handler.layout;
 
             if (layout.requiresPacking())
             {
@@ -730,6 +782,7 @@ std::string generateAssembler (const cmaj::ProgramInterface& p,
             opts.setFPDenormalMode (::llvm::DenormalMode::getPositiveZero());
 
             machineBuilder->setCodeGenOptLevel (LLVMCodeGenerator::getCodeGenOptLevel (buildSettings.getOptimisationLevel()));
+            SIMDTarget (buildSettings, machineBuilder->getTargetTriple()).applyTo (*machineBuilder, false);
 
             if (auto t = machineBuilder->createTargetMachine())
                 targetMachine = std::move (*t);
@@ -737,8 +790,8 @@ std::string generateAssembler (const cmaj::ProgramInterface& p,
     }
     else
     {
-        ::llvm::SmallVector<std::string, 16> attributes {};
-        targetMachine.reset (::llvm::EngineBuilder().selectTarget (::llvm::Triple (options["targetTriple"].toString()), {}, {}, attributes));
+        ::llvm::Triple triple (options["targetTriple"].toString());
+        targetMachine = SIMDTarget (buildSettings, triple).createTargetMachine (triple);
 
         if (! targetMachine)
             return "Failed to create target machine - is the target triple valid?";
@@ -763,7 +816,12 @@ std::string generateAssembler (const cmaj::ProgramInterface& p,
                                  false);
 
     if (generator.generate())
+    {
+        if (targetFormat == "ir")
+            return generator.printIR();
+
         return generator.printAssembly (*targetMachine, targetFormat == "obj");
+    }
 
     return {};
 }
@@ -64,6 +64,19 @@ struct WebAssemblyEngine
     static constexpr bool supportsExternalFunctions = false;
     static bool engineSupportsIntrinsic (AST::Intrinsic::Type) { return false; }
 
+    /// Binaryen packs the state struct like a choc::value, whereas LLVM uses the wasm32
+    /// data layout, whose rules are the natural C ones
+    static choc::value::Value createStateLayoutReport (const AST::Program& program)
+    {
+        return transformations::createStateLayoutReport (program, [] (const AST::TypeBase& t) -> transformations::TypeSizeAndAlignment
+        {
+            if constexpr (useBinaryen)
+                return { t.toChocType().getValueDataSize(), 1 };
+            else
+                return transformations::getNaturalTypeLayout (t, true);
+        });
+    }
+
     //==============================================================================
     struct LinkedCode
     {
@@ -75,10 +88,22 @@ struct WebAssemblyEngine
 
             wrapperJavascript = gen.generate();
             mainClassName = gen.mainClassName;
+
+            for (auto& e : wasmEngine.engine.endpointHandles)
+                if (e.details.isInput && e.details.isEvent())
+                    eventHandlerNames.push_back ({ e.handle, getEventHandlerFunctionNames (e, "sendInputEvent_") });
         }
 
         std::string wrapperJavascript, mainClassName;
         double latency;
+
+        struct EventHandlerNames
+        {
+            EndpointHandle handle;
+            std::vector<std::string> names;
+        };
+
+        std::vector<EventHandlerNames> eventHandlerNames;
     };
 
     //==============================================================================
@@ -303,11 +328,19 @@ initialisePatch();
             };
         }
 
-        std::function<void(const void*)> createSendEventFunction (const EndpointInfo&, const AST::TypeBase& type, const AST::Function& f)
+        std::function<void(const void*)> createSendEventFunction (const EndpointInfo& e, uint32_t typeIndex)
         {
-            auto eventType = type.toChocType();
-            auto command = instanceName + "." + AST::getEventHandlerFunctionName (f, "sendInputEvent_") + "(";
-            auto temp = choc::value::Value (eventType);
+            std::string functionName;
+
+            for (auto& h : code->eventHandlerNames)
+                if (h.handle == e.handle)
+                    functionName = h.names[typeIndex];
+
+            if (functionName.empty())
+                return {};
+
+            auto command = instanceName + "." + functionName + "(";
+            auto temp = choc::value::Value (e.details.dataTypes[typeIndex]);
 
             return [this, command, temp = std::move (temp)] (const void* eventData) mutable
             {
@@ -24,6 +24,7 @@
 #include "../AST/cmaj_AST.h"
 #include "../codegen/cmaj_GraphGenerator.h"
 #include "../transformations/cmaj_Transformations.h"
+#include "../diagnostics/cmaj_CompileProfiler.h"
 #include "CPlusPlus/cmaj_CPlusPlus.h"
 #include "WebAssembly/cmaj_WebAssembly.h"
 #include "LLVM/cmaj_LLVM.h"
@@ -34,10 +35,33 @@ namespace cmaj
 struct EndpointInfo
 {
     EndpointHandle handle;
-    AST::EndpointDeclaration& endpoint;
+
+    /// This is only valid until the engine has been linked, at which point it lets go
+    /// of the program. Performers must only use the handle and details.
+    ptr<AST::EndpointDeclaration> endpoint;
+
     EndpointDetails details;
 };
 
+/// For an input event endpoint, returns the name of the function that handles each of
+/// its data types, or an empty string for any type that the program doesn't handle.
+static std::vector<std::string> getEventHandlerFunctionNames (const EndpointInfo& e, const std::string& prefix)
+{
+    std::vector<std::string> names;
+
+    for (auto& dataType : e.endpoint->dataTypes)
+    {
+        auto& t = AST::castToRefSkippingReferences<AST::TypeBase> (dataType);
+
+        if (auto handlerFunction = AST::findEventHandlerFunction (*e.endpoint, t))
+            names.push_back (AST::getEventHandlerFunctionName (*handlerFunction, prefix));
+        else
+            names.emplace_back();
+    }
+
+    return names;
+}
+
 
 //==============================================================================
 template <typename Implementation>
@@ -66,6 +90,7 @@ struct EngineBase  : public choc::com::ObjectWithAtomicRefCount<EngineInterface,
     choc::com::StringPtr loadedProgramDetailsJSON;
     std::shared_ptr<typename Implementation::LinkedCode> linkedCode;
     CompilePerformanceTimes compilePerformanceTimes;
+    std::unique_ptr<CompileProfiler> compileProfiler;
     std::vector<EndpointInfo> endpointHandles;
     uint32_t nextHandle = 1;
 
@@ -103,17 +128,60 @@ struct EngineBase  : public choc::com::ObjectWithAtomicRefCount<EngineInterface,
         loadedProgramDetailsJSON = {};
     }
 
-    bool isLoaded() override        { return loadedProgram != nullptr; }
+    bool isLoaded() override        { return loadedProgram != nullptr || isLinked(); }
     bool isLinked() override        { return linkedCode != nullptr; }
 
+    /// Once the code has been linked, nothing that the performers use refers to the AST,
+    /// so the engine lets go of the program. Unless the caller is still holding onto it,
+    /// this frees the whole of the memory pool that the build used.
+    void releaseProgram()
+    {
+        for (auto& e : endpointHandles)
+            e.endpoint = {};
+
+        if (compileProfiler != nullptr)
+            compileProfiler->allocator = {};
+
+        mainProcessor = {};
+        newProgram.reset();
+        program.reset();
+        loadedProgram.reset();
+    }
+
     choc::com::String* getProgramDetails() override
     {
-        if (loadedProgram == nullptr)
+        if (! isLoaded())
             return nullptr;
 
         return loadedProgramDetailsJSON.getWithIncrementedRefCount();
     }
 
+    /// Describes the main graph's nodes as a list of stages which each contain nodes with no
+    /// dependencies on each other. This only appears in the program details as a diagnostic:
+    /// the generated code still runs the nodes one after another. Returns a void value if
+    /// the graph is purely serial.
+    static choc::value::Value getParallelExecutionStages (const AST::Graph& graph)
+    {
+        auto stages = GraphConnectivityModel (graph).getExecutionStages();
+
+        if (std::none_of (stages.begin(), stages.end(), [] (auto& s) { return s.size() > 1; }))
+            return {};
+
+        auto result = choc::value::createEmptyArray();
+
+        for (auto& stage : stages)
+        {
+            auto nodeNames = choc::value::createEmptyArray();
+
+            for (auto node : stage)
+                nodeNames.addArrayElement (std::string (node->getOriginalName()));
+
+            result.addArrayElement (nodeNames);
+        }
+
+        return result;
+    }
+
     choc::com::StringPtr createProgramDetails() const
     {
         auto details = choc::value::createObject ({});
@@ -129,6 +197,11 @@ struct EngineBase  : public choc::com::ObjectWithAtomicRefCount<EngineInterface,
         details.setMember ("inputs",  getProgram().endpointList.inputEndpointDetails.toJSON (true));
         details.setMember ("outputs", getProgram().endpointList.outputEndpointDetails.toJSON (true));
 
+        if (mainProcessor != nullptr)
+            if (auto graph = mainProcessor->getAsGraph())
+                if (auto stages = getParallelExecutionStages (*graph); ! stages.isVoid())
+                    details.setMember ("parallelStages", stages);
+
         return choc::com::createString (choc::json::toString (details, true));
     }
 
@@ -137,16 +210,23 @@ struct EngineBase  : public choc::com::ObjectWithAtomicRefCount<EngineInterface,
                              void* functionContext, EngineInterface::RequestExternalFunctionFn requestExternalFunction) override
     {
         unload();
+        compileProfiler = isProfilingEnabled() ? std::make_unique<CompileProfiler> ("build") : nullptr;
+        CompileProfiler::Activation profilerActivation (compileProfiler.get());
 
         return AST::catchAllErrorsAsJSON (buildSettings.shouldIgnoreWarnings(), [&]
         {
+            SaveProfileOnExit saveProfile (*this);
             auto pc = compilePerformanceTimes.getCounter ("load");
+            CompileProfiler::Scope profilerScope ("load", "build");
 
             if (programToLoad == nullptr)
                 throwError (Errors::emptyProgram());
 
             newProgram = AST::getProgram (*programToLoad);
 
+            if (compileProfiler != nullptr)
+                compileProfiler->allocator = newProgram->allocator;
+
             if (! newProgram->prepareForLoading())
                 throwError (Errors::invalidProgram());
 
@@ -166,6 +246,9 @@ struct EngineBase  : public choc::com::ObjectWithAtomicRefCount<EngineInterface,
             newProgram->setMainProcessor (*newProgram->findMainProcessorCandidate (buildSettings.getMainProcessor()));
             mainProcessor = newProgram->findMainProcessor();
 
+            if (compileProfiler != nullptr)
+                compileProfiler->buildDescription = mainProcessor->getFullyQualifiedReadableName();
+
             transformations::prepareForResolution (*newProgram, buildSettings.getMaxStackSize());
 
             newProgram->endpointList.initialise (*mainProcessor);
@@ -185,16 +268,19 @@ struct EngineBase  : public choc::com::ObjectWithAtomicRefCount<EngineInterface,
 
         bool ignoreWarnings = isLoaded() && buildSettings.shouldIgnoreWarnings();
         std::string compileTime, linkTime;
+        CompileProfiler::Activation profilerActivation (compileProfiler.get());
 
-        return AST::catchAllErrorsAsJSON (ignoreWarnings, [&]
+        auto result = AST::catchAllErrorsAsJSON (ignoreWarnings, [&]
         {
             if (! isLoaded())
                 throwError (Errors::noProgramLoaded());
 
+            SaveProfileOnExit saveProfile (*this);
             double latency = 0;
 
             {
                 auto pc = compilePerformanceTimes.getCounter ("compile");
+                CompileProfiler::Scope profilerScope ("compile", "build");
 
                 transformations::prepareForCodeGen (*program,
                                                     buildSettings,
@@ -209,6 +295,7 @@ struct EngineBase  : public choc::com::ObjectWithAtomicRefCount<EngineInterface,
 
             {
                 auto pc = compilePerformanceTimes.getCounter ("link");
+                CompileProfiler::Scope profilerScope ("link", "build");
 
                 std::string cacheKey;
 
@@ -220,13 +307,45 @@ struct EngineBase  : public choc::com::ObjectWithAtomicRefCount<EngineInterface,
                                                                                     latency, cache, cacheKey.c_str());
             }
         });
+
+        if (isLinked())
+            releaseProgram();
+
+        return result;
     }
 
     choc::com::String* getLastBuildLog() override
     {
-        return choc::com::createRawString (compilePerformanceTimes.getResults());
+        auto log = compilePerformanceTimes.getResults();
+
+        if (compileProfiler != nullptr)
+            log += "\n\nSlowest build stages:\n" + compileProfiler->getSummary();
+
+        return choc::com::createRawString (log);
+    }
+
+    //==============================================================================
+    /// Profiling is enabled by an engine option "compileProfile", whose value is the
+    /// path of a file to which a Chrome trace of each build should be written.
+    bool isProfilingEnabled() const
+    {
+        return options.isObject() && options.hasObjectMember ("compileProfile");
     }
 
+    struct SaveProfileOnExit
+    {
+        SaveProfileOnExit (EngineBase& e) : engine (e) {}
+
+        ~SaveProfileOnExit()
+        {
+            if (engine.compileProfiler != nullptr)
+                if (auto path = engine.options["compileProfile"].toString(); ! path.empty())
+                    engine.compileProfiler->addToTraceFile (path);
+        }
+
+        EngineBase& engine;
+    };
+
     std::string getCacheKey()
     {
         auto hash = getProgram().codeHash;
@@ -257,11 +376,15 @@ struct EngineBase  : public choc::com::ObjectWithAtomicRefCount<EngineInterface,
             if (e.details.endpointID == endpointID)
                 return e.handle;
 
+        // New handles can't be added once the program has been linked and released
+        if (program == nullptr)
+            return {};
+
         for (auto& e : getProgram().endpointList.endpoints)
         {
             if (e.details.endpointID == endpointID)
             {
-                EndpointInfo info { nextHandle++, e.endpoint, e.details };
+                EndpointInfo info { nextHandle++, ptr<AST::EndpointDeclaration> (e.endpoint), e.details };
                 endpointHandles.push_back (info);
                 return info.handle;
             }
@@ -272,6 +395,9 @@ struct EngineBase  : public choc::com::ObjectWithAtomicRefCount<EngineInterface,
 
     bool setExternalVariable (const char* name, const void* serialisedValueData, size_t serialisedValueDataSize) override
     {
+        if (newProgram == nullptr)
+            return false;
+
         auto data = static_cast<const uint8_t*> (serialisedValueData);
         choc::value::InputData input { data, data + serialisedValueDataSize };
         bool ok = false;
@@ -299,7 +425,7 @@ struct EngineBase  : public choc::com::ObjectWithAtomicRefCount<EngineInterface,
 
         if (availableTargets.empty())
         {
-            availableTargets = "graph";
+            availableTargets = "graph stateLayout";
 
            #if CMAJ_ENABLE_CODEGEN_CPP
             availableTargets.append (" cpp");
@@ -324,12 +450,16 @@ struct EngineBase  : public choc::com::ObjectWithAtomicRefCount<EngineInterface,
     {
         cmaj::DiagnosticMessageList messages;
         std::string output, mainClassName;
+        CompileProfiler::Activation profilerActivation (compileProfiler.get());
 
         cmaj::catchAllErrors (messages, [&]
         {
             if (! isLoaded())
                 throwError (Errors::noProgramLoaded());
 
+            SaveProfileOnExit saveProfile (*this);
+            CompileProfiler::Scope profilerScope ("generateCode", "build");
+
             if (isLinked())
                 throwError (Errors::cannotGenerateIfLinked());
 
@@ -372,6 +502,12 @@ struct EngineBase  : public choc::com::ObjectWithAtomicRefCount<EngineInterface,
             auto optionsString = optionsJSON != nullptr ? std::string_view (optionsJSON) : std::string_view();
             (void) optionsString;
 
+            if (type == "stateLayout")
+            {
+                output = choc::json::toString (implementation->createStateLayoutReport (*program), true);
+                outputTypeKnown = true;
+            }
+
            #if CMAJ_ENABLE_CODEGEN_CPP
             if (type == "cpp")
             {
@@ -626,20 +762,16 @@ private:
     {
         InputEventHandler (PerformerBase& owner, const EndpointInfo& endpoint)
         {
-            for (auto& dataType : endpoint.endpoint.dataTypes)
+            for (uint32_t i = 0; i < endpoint.details.dataTypes.size(); ++i)
             {
-                auto& t = AST::castToRefSkippingReferences<AST::TypeBase> (dataType);
-                std::function<void(const void*)> handler;
+                auto& type = endpoint.details.dataTypes[i];
+                auto size = static_cast<uint32_t> (type.getValueDataSize());
+                auto handler = owner.jit.createSendEventFunction (endpoint, i);
 
-                if (auto handlerFunction = AST::findEventHandlerFunction (endpoint.endpoint, t))
-                    handler = owner.jit.createSendEventFunction (endpoint, t, *handlerFunction);
-                else
+                if (! handler)
                     handler = [] (const void*) {};
 
-                auto type = t.toChocType();
-                auto size = static_cast<uint32_t> (type.getValueDataSize());
-
-                typeHandlers.push_back ({ std::move (type), size, std::move (handler) });
+                typeHandlers.push_back ({ type, size, std::move (handler) });
             }
         }
 
@@ -96,6 +96,11 @@ struct DummyEngineFactory  : public choc::com::ObjectWithAtomicRefCount<EngineFa
 
         static std::string getEngineVersion()   { return "dummy"; }
 
+        static choc::value::Value createStateLayoutReport (const AST::Program& program)
+        {
+            return transformations::createStateLayoutReport (program, [] (const AST::TypeBase& t) { return transformations::getNaturalTypeLayout (t, true); });
+        }
+
         struct LinkedCode { LinkedCode (const DummyEngine&, uint32_t, double, CacheDatabaseInterface*, const char*) {} static constexpr double latency = 0; };
         struct JITInstance { JITInstance (std::shared_ptr<LinkedCode>, int32_t, double) {} };
 
@@ -309,4 +309,47 @@ struct CompilePerformanceTimes
 };
 
 
+//==============================================================================
+/// Finds the [[ optimise: n ]] and [[ fastmath ]] annotations which apply to a
+/// function, either directly or via one of its parent processors or namespaces.
+/// Annotations on inner scopes override those on outer ones.
+struct FunctionOptimisationAnnotations
+{
+    FunctionOptimisationAnnotations (const AST::Function& f)
+    {
+        std::vector<const AST::Annotation*> annotations;
+
+        if (auto a = AST::castTo<AST::Annotation> (f.annotation))
+            annotations.push_back (a.get());
+
+        for (auto module = f.findParentModule(); module != nullptr; module = module->findParentModule())
+            if (auto a = AST::castTo<AST::Annotation> (module->annotation))
+                annotations.push_back (a.get());
+
+        for (auto a = annotations.rbegin(); a != annotations.rend(); ++a)
+        {
+            if (auto level = (*a)->findConstantProperty ("optimise"))
+            {
+                if (auto n = level->getAsInt32())
+                {
+                    optimisationLevel = *n;
+                    useFastMaths = (*n >= 4);
+                }
+            }
+
+            if (auto fastMaths = (*a)->findConstantProperty ("fastmath"))
+                if (auto b = fastMaths->getAsBool())
+                    useFastMaths = *b;
+        }
+    }
+
+    bool hasAnnotations() const                                 { return optimisationLevel.has_value() || useFastMaths.has_value(); }
+    int getOptimisationLevel (int defaultLevel) const           { return optimisationLevel.value_or (defaultLevel); }
+    bool shouldUseFastMaths (bool defaultFastMaths) const       { return useFastMaths.value_or (defaultFastMaths); }
+
+    std::optional<int> optimisationLevel;
+    std::optional<bool> useFastMaths;
+};
+
+
 } // namespace cmaj
@@ -0,0 +1,353 @@
+//
+//     ,ad888ba,                              88
+//    d8"'    "8b
+//   d8            88,dba,,adba,   ,aPP8A.A8  88     The Cmajor Toolkit
+//   Y8,           88    88    88  88     88  88
+//    Y8a.   .a8P  88    88    88  88,   ,88  88     (C)2024 Cmajor Software Ltd
+//     '"Y888Y"'   88    88    88  '"8bbP"Y8  88     https://cmajor.dev
+//                                           ,88
+//                                        888P"
+//
+//  The Cmajor project is subject to commercial or open-source licensing.
+//  You may use it under the terms of the GPLv3 (see www.gnu.org/licenses), or
+//  visit https://cmajor.dev to learn about our commercial licence options.
+//
+//  CMAJOR IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+//  EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+//  DISCLAIMED.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include "choc/platform/choc_HighResolutionSteadyClock.h"
+#include "choc/text/choc_StringUtilities.h"
+#include "choc/text/choc_JSON.h"
+#include "../AST/cmaj_AST.h"
+
+namespace cmaj
+{
+
+//==============================================================================
+/// Records how long each stage of a build takes, along with how many AST objects
+/// and bytes of AST memory it allocates.
+///
+/// The compiler code marks its stages with Scope objects, which cost nothing unless
+/// a profiler has been activated on the current thread. The results can be summarised
+/// as text, or saved in the Chrome trace-event format to be viewed with chrome://tracing
+/// or https://ui.perfetto.dev
+///
+struct CompileProfiler
+{
+    CompileProfiler (std::string buildDescription);
+
+    /// A name for the build, which is shown as its process name in a trace.
+    std::string buildDescription;
+
+    /// The AST whose allocations should be measured, if any.
+    ptr<const AST::Allocator> allocator;
+
+    //==============================================================================
+    /// While one of these exists, any Scope objects on the current thread report
+    /// to the given profiler. A null profiler disables profiling.
+    struct Activation
+    {
+        Activation (CompileProfiler*);
+        ~Activation();
+
+        Activation (const Activation&) = delete;
+
+    private:
+        CompileProfiler* previous;
+    };
+
+    static CompileProfiler* getActive()     { return getActiveProfilerPointer(); }
+
+    /// Records an event covering the lifetime of this object, if a profiler is active.
+    struct Scope
+    {
+        Scope (std::string_view name, std::string_view category);
+        ~Scope();
+
+        Scope (const Scope&) = delete;
+
+    private:
+        CompileProfiler* profiler;
+        size_t event;
+    };
+
+    //==============================================================================
+    static constexpr size_t noEvent = ~static_cast<size_t> (0);
+
+    size_t beginEvent (std::string_view name, std::string_view category);
+    void endEvent (size_t event);
+    void setEventArgument (size_t event, std::string_view name, const choc::value::ValueView& value);
+
+    /// Returns a table of the stages that took longest, with calls to the same stage combined.
+    std::string getSummary (size_t maxNumStages = 20) const;
+
+    /// Returns this build's events in the Chrome trace-event format.
+    choc::value::Value getTraceEvents() const;
+
+    /// Appends this build's events to the trace file at the given path. Each build
+    /// appears as a separate process, so that several builds (e.g. from a test run)
+    /// can share one file. The file is replaced by the first build to be added to it
+    /// in this process, and the events array is closed when the process exits.
+    void addToTraceFile (const std::string& path) const;
+
+private:
+    using Clock = choc::HighResolutionSteadyClock;
+
+    struct Event
+    {
+        std::string name, category;
+        double startMicroseconds = 0, durationMicroseconds = 0;
+        size_t startObjects = 0, startBytes = 0, numObjectsAllocated = 0, numBytesAllocated = 0;
+        choc::value::Value arguments;
+        bool finished = false;
+    };
+
+    uint32_t buildID;
+    std::vector<Event> events;
+
+    static CompileProfiler*& getActiveProfilerPointer()
+    {
+        static thread_local CompileProfiler* active = nullptr;
+        return active;
+    }
+
+    static double getMicrosecondsSinceStart();
+
+    struct TraceFileWriter;
+};
+
+
+//==============================================================================
+//        _        _           _  _
+//     __| |  ___ | |_   __ _ (_)| | ___
+//    / _` | / _ \| __| / _` || || |/ __|
+//   | (_| ||  __/| |_ | (_| || || |\__ \ _  _  _
+//    \__,_| \___| \__| \__,_||_||_||___/(_)(_)(_)
+//
+//   Code beyond this point is implementation detail...
+//
+//==============================================================================
+
+inline CompileProfiler::CompileProfiler (std::string description) : buildDescription (std::move (description))
+{
+    static std::atomic<uint32_t> nextBuildID { 1 };
+    buildID = nextBuildID++;
+}
+
+inline CompileProfiler::Activation::Activation (CompileProfiler* p) : previous (getActiveProfilerPointer())
+{
+    getActiveProfilerPointer() = p;
+}
+
+inline CompileProfiler::Activation::~Activation()
+{
+    getActiveProfilerPointer() = previous;
+}
+
+inline CompileProfiler::Scope::Scope (std::string_view name, std::string_view category) : profiler (getActive())
+{
+    event = profiler != nullptr ? profiler->beginEvent (name, category) : noEvent;
+}
+
+inline CompileProfiler::Scope::~Scope()
+{
+    if (profiler != nullptr)
+        profiler->endEvent (event);
+}
+
+inline double CompileProfiler::getMicrosecondsSinceStart()
+{
+    // All builds share the same origin, so that their events line up in a trace
+    static const auto processStartTime = Clock::now();
+    return std::chrono::duration<double, std::micro> (Clock::now() - processStartTime).count();
+}
+
+inline size_t CompileProfiler::beginEvent (std::string_view name, std::string_view category)
+{
+    Event e;
+    e.name = std::string (name);
+    e.category = std::string (category);
+
+    if (allocator != nullptr)
+    {
+        e.startObjects = allocator->numObjectsAllocated;
+        e.startBytes = allocator->getNumBytesAllocated();
+    }
+
+    e.startMicroseconds = getMicrosecondsSinceStart();
+    events.push_back (std::move (e));
+    return events.size() - 1;
+}
+
+inline void CompileProfiler::endEvent (size_t index)
+{
+    if (index >= events.size())
+        return;
+
+    auto& e = events[index];
+    e.durationMicroseconds = getMicrosecondsSinceStart() - e.startMicroseconds;
+    e.finished = true;
+
+    if (allocator != nullptr)
+    {
+        e.numObjectsAllocated = allocator->numObjectsAllocated - e.startObjects;
+        e.numBytesAllocated = allocator->getNumBytesAllocated() - e.startBytes;
+    }
+}
+
+inline void CompileProfiler::setEventArgument (size_t index, std::string_view name, const choc::value::ValueView& value)
+{
+    if (index >= events.size())
+        return;
+
+    auto& args = events[index].arguments;
+
+    if (! args.isObject())
+        args = choc::value::createObject ({});
+
+    args.setMember (name, value);
+}
+
+inline std::string CompileProfiler::getSummary (size_t maxNumStages) const
+{
+    struct Total
+    {
+        std::string_view name;
+        double microseconds = 0;
+        size_t numCalls = 0, numObjectsAllocated = 0, numBytesAllocated = 0;
+    };
+
+    std::vector<Total> totals;
+
+    for (auto& e : events)
+    {
+        if (! e.finished)
+            continue;
+
+        auto t = std::find_if (totals.begin(), totals.end(), [&] (const Total& total) { return total.name == e.name; });
+
+        if (t == totals.end())
+            t = totals.insert (totals.end(), Total { e.name });
+
+        t->microseconds += e.durationMicroseconds;
+        t->numCalls++;
+        t->numObjectsAllocated += e.numObjectsAllocated;
+        t->numBytesAllocated += e.numBytesAllocated;
+    }
+
+    std::stable_sort (totals.begin(), totals.end(), [] (const Total& a, const Total& b) { return a.microseconds > b.microseconds; });
+
+    if (totals.size() > maxNumStages)
+        totals.resize (maxNumStages);
+
+    std::vector<std::string> lines;
+
+    for (auto& t : totals)
+        lines.push_back (std::string (t.name) + ": "
+                          + choc::text::getDurationDescription (std::chrono::duration<double, std::micro> (t.microseconds))
+                          + (t.numCalls > 1 ? " (" + std::to_string (t.numCalls) + " calls)" : std::string())
+                          + (t.numObjectsAllocated != 0 ? ", " + std::to_string (t.numObjectsAllocated) + " AST objects, "
+                                                              + choc::text::getByteSizeDescription (t.numBytesAllocated)
+                                                        : std::string()));
+
+    return choc::text::joinStrings (lines, "\n");
+}
+
+inline choc::value::Value CompileProfiler::getTraceEvents() const
+{
+    auto result = choc::value::createEmptyArray();
+
+    result.addArrayElement (choc::json::create ("name", "process_name",
+                                                "ph", "M",
+                                                "pid", static_cast<int64_t> (buildID),
+                                                "args", choc::json::create ("name", buildDescription)));
+
+    for (auto& e : events)
+    {
+        if (! e.finished)
+            continue;
+
+        auto event = choc::json::create ("name", e.name,
+                                         "cat", e.category,
+                                         "ph", "X",
+                                         "ts", e.startMicroseconds,
+                                         "dur", e.durationMicroseconds,
+                                         "pid", static_cast<int64_t> (buildID),
+                                         "tid", static_cast<int64_t> (1));
+
+        auto args = e.arguments.isObject() ? e.arguments : choc::value::createObject ({});
+
+        if (allocator != nullptr)
+        {
+            args.setMember ("astObjectsAllocated", static_cast<int64_t> (e.numObjectsAllocated));
+            args.setMember ("astBytesAllocated", static_cast<int64_t> (e.numBytesAllocated));
+        }
+
+        if (args.size() != 0)
+            event.setMember ("args", args);
+
+        result.addArrayElement (event);
+
+        if (allocator != nullptr)
+            result.addArrayElement (choc::json::create ("name", "AST memory",
+                                                        "ph", "C",
+                                                        "ts", e.startMicroseconds + e.durationMicroseconds,
+                                                        "pid", static_cast<int64_t> (buildID),
+                                                        "args", choc::json::create ("bytes", static_cast<int64_t> (e.startBytes + e.numBytesAllocated))));
+    }
+
+    return result;
+}
+
+/// Streams events into a file in the trace-event array format, so that nothing needs to
+/// be kept in memory or rewritten as more builds are added.
+struct CompileProfiler::TraceFileWriter
+{
+    TraceFileWriter (const std::string& path) : stream (path, std::ios::binary | std::ios::trunc)
+    {
+        stream << "[";
+    }
+
+    ~TraceFileWriter()
+    {
+        stream << "\n]\n";
+    }
+
+    void write (const choc::value::ValueView& events)
+    {
+        for (auto e : events)
+        {
+            stream << (isFirstEvent ? "\n" : ",\n") << choc::json::toString (e);
+            isFirstEvent = false;
+        }
+
+        stream.flush();
+    }
+
+    std::ofstream stream;
+    bool isFirstEvent = true;
+};
+
+inline void CompileProfiler::addToTraceFile (const std::string& path) const
+{
+    // The writers are only destroyed at exit, which is when their arrays get closed
+    static std::mutex lock;
+    static std::unordered_map<std::string, std::unique_ptr<TraceFileWriter>> writers;
+
+    std::lock_guard<std::mutex> l (lock);
+    auto& writer = writers[path];
+
+    if (writer == nullptr)
+        writer = std::make_unique<TraceFileWriter> (path);
+
+    writer->write (getTraceEvents());
+}
+
+} // namespace cmaj
@@ -52,6 +52,7 @@ DECL_COMPILE_ERROR (complexNumberSuffixNeedsFloat,          "The 'i' suffix for
 DECL_COMPILE_ERROR (errorInNumericLiteral,                  "Syntax error in numeric constant")
 DECL_COMPILE_ERROR (noOctalLiterals,                        "Octal literals are not supported")
 DECL_COMPILE_ERROR (integerLiteralTooLarge,                 "Integer literal is too large to be represented")
+DECL_COMPILE_ERROR (floatLiteralOutOfRange,                 "Floating-point literal is out of range")
 DECL_COMPILE_ERROR (integerLiteralNeedsSuffix,              "This value is too large to fit into an int32, did you mean to add an 'i64' suffix?")
 DECL_COMPILE_ERROR (noLeadingUnderscoreAllowed,             "Identifiers beginning with an underscore are reserved for system use")
 
@@ -223,6 +224,12 @@ DECL_COMPILE_ERROR (cannotResolveGenericParameter,          "Could not resolve g
 DECL_COMPILE_ERROR (cannotResolveGenericFunction,           "Failed to resolve generic function call {0}")
 DECL_COMPILE_ERROR (cannotResolveGenericWildcard,           "Could not find a value for '{0}' that satisfies all argument types")
 DECL_COMPILE_ERROR (unresolvedAnnotation,                   "Cannot resolve annotation value as a compile-time constant")
+DECL_COMPILE_ERROR (lookupTableNeedsFloatFunction,          "A function with a 'lut' annotation must take a single floating-point parameter and return a floating-point value")
+DECL_COMPILE_ERROR (lookupTableNeedsRange,                  "A 'lut' annotation must provide 'min' and 'max' properties to give the range of its input")
+DECL_COMPILE_ERROR (lookupTableSizeOutOfRange,              "The size of a lookup table must be between 2 and {0}")
+DECL_COMPILE_ERROR (cannotEvaluateForLookupTable,           "Cannot create a lookup table for this function, because its result can't be calculated at compile-time")
+DECL_COMPILE_ERROR (optimiseAnnotationOutOfRange,           "An 'optimise' annotation must be an integer between 0 and 4")
+DECL_COMPILE_ERROR (fastmathAnnotationMustBeBool,           "A 'fastmath' annotation must be a boolean value")
 DECL_COMPILE_ERROR (functionHasNoImplementation,            "This function has no implementation")
 
 // Expression and statement errors
@@ -361,13 +368,18 @@ DECL_COMPILE_ERROR (noProgramLoaded,                        "No program loaded")
 DECL_COMPILE_ERROR (cannotGenerateIfLinked,                 "Cannot generate once a program has been linked")
 DECL_COMPILE_ERROR (maximumStackSizeExceeded,               "Stack size limit exceeded - program requires {0}, maximum allowed is {1}")
 DECL_COMPILE_ERROR (unsupportedSampleRate,                  "Unsupported sample rate")
+DECL_COMPILE_ERROR (cannotFindMathsApproximations,          "The standard library does not provide maths approximations for level {0}")
 DECL_COMPILE_ERROR (failedToCompile,                        "Failed to compile {0}")
 DECL_COMPILE_ERROR (failedToLink,                           "Failed to link {0}")
 DECL_COMPILE_ERROR (failedToJit,                            "Failed to construct jit {0}")
+DECL_COMPILE_ERROR (unknownSIMDTarget,                      "Unknown SIMD target '{0}' - expected one of: native, sse2, avx2, avx512, neon")
+DECL_COMPILE_ERROR (simdTargetNotAvailable,                 "The SIMD target '{0}' can't be used for the architecture '{1}'")
+DECL_COMPILE_ERROR (simdTargetNotSupportedByCPU,            "The SIMD target '{0}' can't be used for JIT compilation, because this CPU doesn't support it")
 
 // Warnings
 DECL_WARNING (indexHasRuntimeOverhead,                      "Performance warning: the type of this array index could not be proven to be safe, so a runtime check was added")
 DECL_WARNING (localVariableShadow,                          "'{0}' shadows another declaration with the same name")
+DECL_WARNING (lookupTableAccuracy,                          "'{0}' has been replaced by a {1}-point lookup table, with a maximum error of {2}")
 
 DECL_NOTE (seePreviousDeclaration,                          "See previous declaration")
 DECL_NOTE (seeSourceOfLocalData,                            "See context where local data is assigned")
@@ -560,7 +560,7 @@ struct FunctionResolver  : public PassAvoidingGenericFunctionsAndModules
         if (fn->isMainFunction() || fn->isUserInitFunction() || fn->isEventHandler)
             throwError (AST::getContextOfStartOfExpression (nameToResolve), Errors::cannotCallFunction (fn->name.get()));
 
-        fn = ModuleSpecialiser::getFunctionWithSpecialisedParentModules (program, call.context, fn, throwOnErrors);
+        fn = ModuleSpecialiser::getFunctionWithSpecialisedParentModules (program, worklist, call.context, fn, throwOnErrors);
 
         if (fn->getParentModule().isAnyParentParameterised())
         {
@@ -593,8 +593,8 @@ struct FunctionResolver  : public PassAvoidingGenericFunctionsAndModules
         return {};
     }
 
-    static AST::Function& findOrCreateSpecialisedFunction (AST::Expression& call, const MatchingFunctionList::Match& genericFunctionInfo,
-                                                           choc::span<ref<const AST::Expression>> resolvedWildcards)
+    AST::Function& findOrCreateSpecialisedFunction (AST::Expression& call, const MatchingFunctionList::Match& genericFunctionInfo,
+                                                    choc::span<ref<const AST::Expression>> resolvedWildcards)
     {
         auto& genericFn = genericFunctionInfo.function.get();
 
@@ -604,15 +604,16 @@ struct FunctionResolver  : public PassAvoidingGenericFunctionsAndModules
         for (auto& w : resolvedWildcards)
             sig << w;
 
-        auto specialisedFunctionName = sig.toString (50);
+        auto specialisedFunctionName = genericFn.getStringPool().get (sig.toString (50));
 
         auto& parentModule = genericFn.getParentModule();
 
-        if (auto existing = parentModule.findFunction (specialisedFunctionName, genericFn.parameters.size()))
+        if (auto existing = findSpecialisation<AST::Function> (genericFn, specialisedFunctionName,
+                                                               [&] { return parentModule.findFunction (specialisedFunctionName, genericFn.parameters.size()); }))
             return *existing;
 
         auto& specialisedFn = parentModule.context.allocator.createDeepClone (genericFn);
-        specialisedFn.name = specialisedFn.getStringPool().get (specialisedFunctionName);
+        specialisedFn.name = specialisedFunctionName;
         specialisedFn.originalGenericFunction.referTo (genericFn);
         specialisedFn.originalCallLeadingToSpecialisation.referTo (call);
 
@@ -655,6 +656,7 @@ struct FunctionResolver  : public PassAvoidingGenericFunctionsAndModules
         }
 
         parentModule.functions.addChildObject (specialisedFn);
+        addSpecialisation (genericFn, specialisedFunctionName, specialisedFn);
         return specialisedFn;
     }
 
@@ -967,6 +969,9 @@ struct FunctionResolver  : public PassAvoidingGenericFunctionsAndModules
                                                      : Errors::cannotUseOutputAsFunction());
         }
 
+        // The compile is going to fail, so it doesn't matter that this attaches any
+        // parts of the library that nothing has used, so that they can be searched too
+        program.attachAllLibraryNamespaces();
         auto possibleFunction = findMisspeltFunctionSuggestion (call, functionName).fullPath;
 
         if (! possibleFunction.empty())
@@ -145,8 +145,10 @@ struct ModuleSpecialiser  : public Pass
             specialisedName = specialisedName + "_" + std::to_string (graphNode->getClockMultiplier());
 
         auto specialisedNamePooled = target.getStringPool().get (specialisedName);
+        auto& parentNamespace = target.getParentNamespace();
 
-        if (auto existingInstance = target.getParentNamespace().findChildModule (specialisedNamePooled))
+        if (auto existingInstance = findSpecialisation<AST::ModuleBase> (target, specialisedNamePooled,
+                                                                          [&] { return parentNamespace.findChildModule (specialisedNamePooled); }))
             return existingInstance;
 
         checkNumberOfClones (target);
@@ -154,29 +156,49 @@ struct ModuleSpecialiser  : public Pass
         auto& newInstance = AST::createClonedSiblingModule (target, specialisedName);
         args.applyToTarget (newInstance);
         newInstance.specialisationParams.reset();
+        addSpecialisation (target, specialisedNamePooled, newInstance);
 
-        CMAJ_ASSERT (target.getParentNamespace().findChildModule (specialisedNamePooled) == newInstance);
+        CMAJ_ASSERT (parentNamespace.findChildModule (specialisedNamePooled) == newInstance);
         return newInstance;
     }
 
-    static AST::Function& getFunctionWithSpecialisedParentModules (AST::Program& p, const AST::ObjectContext& errorContext, AST::Function& fn, bool shouldThrowOnErrors)
+    static AST::Function& getFunctionWithSpecialisedParentModules (AST::Program& p, ptr<ModuleWorklist> worklist, const AST::ObjectContext& errorContext,
+                                                                   AST::Function& fn, bool shouldThrowOnErrors)
     {
         if (auto parentModule = fn.findParentModule())
+        {
             if (parentModule->isAnyParentParameterised())
-                if (auto newParent = ModuleSpecialiser (p).specialiseIfNeeded (errorContext, *parentModule, shouldThrowOnErrors))
+            {
+                ModuleSpecialiser specialiser (p);
+                specialiser.worklist = worklist;
+
+                if (auto newParent = specialiser.specialiseIfNeeded (errorContext, *parentModule, shouldThrowOnErrors))
                     return *newParent->findFunction (fn.getName(), fn.getNumParameters());
+            }
+        }
 
         return fn;
     }
 
-    static void checkNumberOfClones (AST::ModuleBase& target)
+    /// Called before creating a new clone of the target, to make sure it hasn't already been cloned too many times
+    void checkNumberOfClones (AST::ModuleBase& target)
     {
-        size_t cloneCount = 0;
+        auto countClones = [&]
+        {
+            size_t count = 0;
+
+            for (auto& module : target.getParentNamespace().getSubModules())
+                if (module->originalName.get() == target.getName())
+                    ++count;
+
+            return count;
+        };
+
+        auto numExistingClones = worklist != nullptr ? worklist->specialisations.addClone (target, countClones)
+                                                     : countClones();
 
-        for (auto& module : target.getParentNamespace().getSubModules())
-            if (module->originalName.get() == target.getName())
-                if (++cloneCount > maxCloneCount)
-                    throwError (target.context, Errors::tooManyNamespaceInstances (std::to_string (maxCloneCount)));
+        if (numExistingClones > maxCloneCount)
+            throwError (target.context, Errors::tooManyNamespaceInstances (std::to_string (maxCloneCount)));
     }
 
     //==============================================================================
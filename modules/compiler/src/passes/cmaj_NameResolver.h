@@ -285,6 +285,9 @@ struct NameResolver  : public PassAvoidingGenericFunctionsAndModules
 
     bool performNameSearch (AST::Expression& nameObject, AST::PooledString name, bool onlyFindNamespaces)
     {
+        if (onlyFindNamespaces && isInsideStdNamespace (nameObject))
+            program.attachLibraryNamespace (name);
+
         AST::NameSearch search;
         findAllMatches (search, nameObject, name, onlyFindNamespaces);
 
@@ -328,6 +331,14 @@ struct NameResolver  : public PassAvoidingGenericFunctionsAndModules
         return true;
     }
 
+    /// An unqualified name can only find one of the std namespace's children if the search
+    /// passes through the std namespace, so lookups from anywhere else needn't attach one
+    bool isInsideStdNamespace (AST::Object& nameObject) const
+    {
+        auto stdNamespace = program.rootNamespace.findSystemChildNamespace (program.allocator.strings.stdLibraryNamespaceName);
+        return stdNamespace != nullptr && nameObject.isChildOf (*stdNamespace);
+    }
+
     void resolveChildOfModule (AST::NamespaceSeparator& separator, AST::ModuleBase& parentModule)
     {
         AST::NameSearch search;
@@ -342,6 +353,9 @@ struct NameResolver  : public PassAvoidingGenericFunctionsAndModules
         search.findEndpoints                = true;
         search.onlyFindLocalVariables       = false;
 
+        if (parentModule.isSystemModule() && parentModule.hasName (program.allocator.strings.stdLibraryNamespaceName))
+            program.attachLibraryNamespace (search.nameToFind);
+
         parentModule.performLocalNameSearch (search, {});
 
         if (handleAmbiguousOrUnknownResult (separator, search))
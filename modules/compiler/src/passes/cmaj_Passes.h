@@ -22,6 +22,183 @@
 
 namespace cmaj::passes
 {
+    //==============================================================================
+    /// Remembers the specialised functions and modules that have been created from each
+    /// generic one, so that repeated calls with the same arguments can find them without
+    /// searching all of their siblings, and keeps a running count of each module's clones.
+    ///
+    /// Nothing is removed from the program while the resolution passes run, so the objects
+    /// that this refers to remain valid for as long as the worklist that owns it.
+    struct SpecialisationCache
+    {
+        ptr<AST::Object> find (const AST::Object& generic, AST::PooledString specialisedName) const
+        {
+            if (auto found = specialisations.find ({ std::addressof (generic), specialisedName }); found != specialisations.end())
+                return found->second;
+
+            return {};
+        }
+
+        void add (const AST::Object& generic, AST::PooledString specialisedName, AST::Object& specialisation)
+        {
+            specialisations[{ std::addressof (generic), specialisedName }] = std::addressof (specialisation);
+        }
+
+        /// Records that a new clone of the given module is being created, and returns the number
+        /// of clones that already existed. The supplied function is used to count them the first
+        /// time a module is seen.
+        template <typename CountClonesFn>
+        size_t addClone (const AST::ModuleBase& original, CountClonesFn&& countClones)
+        {
+            auto found = numClones.find (std::addressof (original));
+
+            if (found == numClones.end())
+                found = numClones.emplace (std::addressof (original), countClones()).first;
+
+            return found->second++;
+        }
+
+    private:
+        struct Key
+        {
+            const AST::Object* generic;
+            AST::PooledString specialisedName;
+
+            bool operator== (const Key& other) const    { return generic == other.generic && specialisedName == other.specialisedName; }
+        };
+
+        struct KeyHash
+        {
+            size_t operator() (const Key& k) const      { return std::hash<const void*>() (k.generic) ^ (k.specialisedName.hash() * 31u); }
+        };
+
+        std::unordered_map<Key, AST::Object*, KeyHash> specialisations;
+        std::unordered_map<const AST::ModuleBase*, size_t> numClones;
+    };
+
+    //==============================================================================
+    /// Keeps track of which modules the next sweep of the resolution passes needs to visit.
+    ///
+    /// The first sweep covers the whole program. After that, a sweep only revisits the
+    /// modules in which something changed or failed to resolve, the modules that refer to
+    /// anything inside those, and any newly-created specialisations. When one of these partial
+    /// sweeps makes no changes, a final full sweep confirms that the entire program has settled,
+    /// so the end result is the same as repeatedly sweeping everything.
+    ///
+    /// Full sweeps leave out any modules that are still marked as pre-resolved, i.e. the
+    /// untouched parts of the standard library image.
+    struct ModuleWorklist
+    {
+        ModuleWorklist (AST::Program& p) : program (p)
+        {
+            for (auto& m : findAllModules())
+            {
+                knownModules.insert (m.getPointer());
+
+                if (! m->isPreResolved)
+                    modulesToVisit.insert (m.getPointer());
+            }
+        }
+
+        /// Returns true if the current sweep needs to look inside this module. Any modules
+        /// nested inside it are selected or skipped individually.
+        bool shouldVisit (const AST::ModuleBase& m) const
+        {
+            return modulesToVisit.find (std::addressof (m)) != modulesToVisit.end();
+        }
+
+        /// The specialisations created so far by the passes that share this worklist.
+        SpecialisationCache specialisations;
+
+        /// Records a change inside a module, so that the module and everything which
+        /// refers to it will be revisited by the next sweep.
+        void markChanged (AST::ModuleBase& m)
+        {
+            m.isPreResolved = false;
+            changedModules.insert (std::addressof (m));
+        }
+
+        /// Makes sure the next sweep revisits a module, without also revisiting its users.
+        void markNeedsRevisit (AST::ModuleBase& m)
+        {
+            m.isPreResolved = false;
+            modulesToRevisit.insert (std::addressof (m));
+        }
+
+        /// Records that something inside one module refers to something inside another.
+        void addDependency (const AST::ModuleBase& user, const AST::ModuleBase& usedModule)
+        {
+            if (std::addressof (user) != std::addressof (usedModule))
+                dependentModules[std::addressof (usedModule)].insert (std::addressof (user));
+        }
+
+        /// Chooses the modules for the next sweep, returning false if the last sweep
+        /// covered the whole program and didn't change anything.
+        bool prepareNextSweep (size_t numChangesInLastSweep)
+        {
+            auto allModules = findAllModules();
+            modulesToVisit.clear();
+
+            if (numChangesInLastSweep == 0)
+            {
+                if (fullSweep)
+                    return false;
+
+                fullSweep = true;
+
+                for (auto& m : allModules)
+                    if (! m->isPreResolved)
+                        modulesToVisit.insert (m.getPointer());
+            }
+            else
+            {
+                fullSweep = false;
+                modulesToVisit = modulesToRevisit;
+
+                for (auto m : changedModules)
+                {
+                    modulesToVisit.insert (m);
+
+                    if (auto dependents = dependentModules.find (m); dependents != dependentModules.end())
+                        modulesToVisit.insert (dependents->second.begin(), dependents->second.end());
+                }
+
+                for (auto& m : allModules)
+                    if (knownModules.find (m.getPointer()) == knownModules.end())
+                        modulesToVisit.insert (m.getPointer());
+            }
+
+            for (auto& m : allModules)
+                knownModules.insert (m.getPointer());
+
+            changedModules.clear();
+            modulesToRevisit.clear();
+            return true;
+        }
+
+    private:
+        AST::Program& program;
+        bool fullSweep = true;
+        std::unordered_set<const AST::ModuleBase*> modulesToVisit, knownModules, changedModules, modulesToRevisit;
+        std::unordered_map<const AST::ModuleBase*, std::unordered_set<const AST::ModuleBase*>> dependentModules;
+
+        std::vector<ref<AST::ModuleBase>> findAllModules() const
+        {
+            std::vector<ref<AST::ModuleBase>> result;
+            addModules (result, program.rootNamespace);
+            return result;
+        }
+
+        static void addModules (std::vector<ref<AST::ModuleBase>>& result, AST::ModuleBase& m)
+        {
+            result.push_back (m);
+
+            if (auto ns = m.getAsNamespace())
+                for (auto& sub : ns->getSubModules())
+                    addModules (result, sub);
+        }
+    };
+
     //==============================================================================
     struct Pass  : public AST::Visitor
     {
@@ -31,9 +208,79 @@ namespace cmaj::passes
         size_t numReplaced = 0, numFailures = 0;
         bool throwOnErrors = false;
 
+        /// If a worklist is supplied, the pass still walks the program from its root, but only
+        /// looks inside the modules which the worklist has selected for the current sweep.
+        /// Changes and failures are recorded against the module in which they happen, and any
+        /// reference that leads into another module is recorded as a dependency on it, but
+        /// is only followed if that module is also being visited.
+        ptr<ModuleWorklist> worklist;
+        ptr<AST::ModuleBase> currentModule;
+
+        void visitObject (AST::Object& o) override
+        {
+            if (worklist == nullptr)
+            {
+                AST::Visitor::visitObject (o);
+                return;
+            }
+
+            ptr<AST::ModuleBase> module = o.getAsModuleBase();
+            bool isReference = ! visitStack.empty() && o.getParentScope().get() != visitStack.back();
+
+            if (isReference)
+            {
+                if (module == nullptr)
+                    module = o.findParentModule();
+
+                if (module == nullptr || module.get() == currentModule.get())
+                {
+                    AST::Visitor::visitObject (o);
+                    return;
+                }
+
+                if (currentModule != nullptr)
+                    worklist->addDependency (*currentModule, *module);
+
+                if (! worklist->shouldVisit (*module))
+                    return;
+            }
+            else if (module == nullptr)
+            {
+                AST::Visitor::visitObject (o);
+                return;
+            }
+            else if (! worklist->shouldVisit (*module))
+            {
+                visitNestedModules (*module);
+                return;
+            }
+
+            auto previousModule = currentModule;
+            currentModule = module;
+            AST::Visitor::visitObject (o);
+            currentModule = previousModule;
+        }
+
+        /// Walks into a module that isn't being visited, to reach any selected modules inside it.
+        void visitNestedModules (AST::ModuleBase& m)
+        {
+            if (auto ns = m.getAsNamespace())
+            {
+                if (shouldVisitObject (m))
+                {
+                    visitStack.push_back (std::addressof (m));
+                    ns->subModules.visitObjects (*this);
+                    visitStack.pop_back();
+                }
+            }
+        }
+
         /// Replaces an object and also registers a change
         void replaceObject (AST::Object& old, AST::Object& replacement)
         {
+            if (auto m = old.findParentModule())
+                m->isPreResolved = false;
+
             if (replacement.isChildOf (old))
                 replacement.setParentScope (*old.getParentScope());
 
@@ -54,12 +301,52 @@ namespace cmaj::passes
         bool registerFailure()
         {
             ++numFailures;
+
+            if (worklist != nullptr && currentModule != nullptr)
+                worklist->markNeedsRevisit (*currentModule);
+
             return throwOnErrors;
         }
 
         void registerChange()
         {
             ++numReplaced;
+
+            if (worklist != nullptr && currentModule != nullptr)
+                worklist->markChanged (*currentModule);
+        }
+
+        /// Looks for an existing specialisation of a generic object, using the worklist's
+        /// cache if there is one, and only calling the search function if that misses.
+        template <typename ObjectType, typename SearchFn>
+        ptr<ObjectType> findSpecialisation (const AST::Object& generic, AST::PooledString specialisedName, SearchFn&& search)
+        {
+            if (worklist == nullptr)
+                return search();
+
+            if (auto cached = worklist->specialisations.find (generic, specialisedName))
+                return AST::castTo<ObjectType> (*cached);
+
+            ptr<ObjectType> found = search();
+
+            if (found != nullptr)
+                worklist->specialisations.add (generic, specialisedName, *found);
+
+            return found;
+        }
+
+        void addSpecialisation (const AST::Object& generic, AST::PooledString specialisedName, AST::Object& specialisation)
+        {
+            if (worklist != nullptr)
+            {
+                worklist->specialisations.add (generic, specialisedName, specialisation);
+
+                // A new module will be picked up by the next sweep anyway, but anything else
+                // may have been added to a module which the worklist would otherwise skip
+                if (specialisation.getAsModuleBase() == nullptr)
+                    if (auto m = specialisation.findParentModule())
+                        worklist->markNeedsRevisit (*m);
+            }
         }
     };
 
@@ -132,6 +419,18 @@ namespace cmaj::passes
 
         return { pass.numReplaced, pass.numFailures };
     }
+
+    /// Runs a pass over the modules that the worklist has selected for its current sweep.
+    template <typename PassType>
+    PassResult runPass (AST::Program& program, ModuleWorklist& worklist, bool throwOnErrors)
+    {
+        PassType pass (program);
+        pass.throwOnErrors = throwOnErrors;
+        pass.worklist = std::addressof (worklist);
+        pass.visitObject (program.rootNamespace);
+
+        return { pass.numReplaced, pass.numFailures };
+    }
 }
 
 #include "cmaj_DuplicateNameChecker.h"
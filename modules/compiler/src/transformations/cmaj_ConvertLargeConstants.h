@@ -38,12 +38,55 @@ static inline void convertLargeConstantsToGlobals (AST::Program& program)
         AST::Namespace& rootNamespace;
         int insideFunction = 0;
 
-        std::vector<ref<AST::VariableDeclaration>> constants;
+        // Globals are indexed by a hash of their values, so that finding a duplicate
+        // only needs a full comparison against constants which are probably identical
+        std::unordered_map<uint64_t, std::vector<ref<AST::VariableDeclaration>>> constantsByHash;
+
+        static void addToHash (choc::hash::xxHash64& hash, ptr<const AST::ConstantValueBase> c)
+        {
+            if (c == nullptr)
+                return;
+
+            if (auto agg = c->getAsConstantAggregate())
+            {
+                auto numValues = static_cast<uint64_t> (agg->values.size());
+                hash.addInput (std::addressof (numValues), sizeof (numValues));
+
+                for (auto& v : agg->values)
+                    addToHash (hash, AST::castToConstant (v));
+            }
+            else if (auto s = c->getAsString())
+            {
+                hash.addInput (*s);
+            }
+            else if (auto d = c->getAsFloat64())
+            {
+                hash.addInput (std::addressof (*d), sizeof (double));
+            }
+            else if (auto complex = c->getAsComplex64())
+            {
+                double parts[] = { complex->real(), complex->imag() };
+                hash.addInput (parts, sizeof (parts));
+            }
+            else if (auto index = c->getAsEnumIndex())
+            {
+                hash.addInput (std::addressof (*index), sizeof (int32_t));
+            }
+        }
+
+        static uint64_t getValueHash (const AST::ValueBase& value)
+        {
+            choc::hash::xxHash64 hash;
+            addToHash (hash, AST::castToConstant (value));
+            return hash.getHash();
+        }
 
         AST::VariableDeclaration& createGlobal (AST::ValueBase& a, const AST::TypeBase& type)
         {
-            for (auto existing : constants)
-                if (existing->isIdentical (a))
+            auto& candidates = constantsByHash[getValueHash (a)];
+
+            for (auto& existing : candidates)
+                if (existing->initialValue->isIdentical (a))
                     return existing;
 
             auto& gv = rootNamespace.context.allocate<AST::VariableDeclaration>();
@@ -53,7 +96,7 @@ static inline void convertLargeConstantsToGlobals (AST::Program& program)
             gv.variableType = AST::VariableTypeEnum::Enum::state;
             gv.isConstant = true;
 
-            constants.push_back (gv);
+            candidates.push_back (gv);
             return gv;
         }
 
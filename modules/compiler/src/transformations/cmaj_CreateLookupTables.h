@@ -0,0 +1,260 @@
+//
+//     ,ad888ba,                              88
+//    d8"'    "8b
+//   d8            88,dba,,adba,   ,aPP8A.A8  88     The Cmajor Toolkit
+//   Y8,           88    88    88  88     88  88
+//    Y8a.   .a8P  88    88    88  88,   ,88  88     (C)2024 Cmajor Software Ltd
+//     '"Y888Y"'   88    88    88  '"8bbP"Y8  88     https://cmajor.dev
+//                                           ,88
+//                                        888P"
+//
+//  The Cmajor project is subject to commercial or open-source licensing.
+//  You may use it under the terms of the GPLv3 (see www.gnu.org/licenses), or
+//  visit https://cmajor.dev to learn about our commercial licence options.
+//
+//  CMAJOR IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+//  EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+//  DISCLAIMED.
+
+#pragma once
+
+namespace cmaj::transformations
+{
+
+//==============================================================================
+/// Finds functions with a [[ lut: size, min: x, max: y ]] annotation, evaluates them
+/// at compile-time across the given input range, and replaces their bodies with a
+/// linearly-interpolated lookup into the resulting table.
+static inline void createLookupTables (AST::Program& program)
+{
+    static constexpr int32_t defaultTableSize = 1024;
+    static constexpr int32_t maxTableSize = 65536;
+
+    struct LookupTableBuilder
+    {
+        LookupTableBuilder (AST::Function& f, const AST::Annotation& a)
+          : function (f), annotation (a),
+            parameter (f.getParameter (0)),
+            parameterType (AST::castToTypeBaseRef (parameter.declaredType).skipConstAndRefModifiers()),
+            returnType (AST::castToTypeBaseRef (f.returnType).skipConstAndRefModifiers())
+        {
+        }
+
+        void build()
+        {
+            auto tableSize = getTableSize();
+            auto minValue  = getRangeProperty ("min");
+            auto maxValue  = getRangeProperty ("max");
+
+            if (! (maxValue > minValue))
+                throwError (annotation, Errors::lookupTableNeedsRange());
+
+            auto& resultExpression = getResultExpression();
+            auto step = (maxValue - minValue) / (tableSize - 1);
+
+            std::vector<double> table;
+            table.reserve (static_cast<size_t> (tableSize) + 1);
+
+            for (int32_t i = 0; i < tableSize; ++i)
+                table.push_back (evaluate (resultExpression, minValue + step * i));
+
+            // The last value is repeated, so that the interpolation can always read the element
+            // after its index without needing a bounds check
+            table.push_back (table.back());
+
+            double maxError = 0;
+
+            for (int32_t i = 0; i < tableSize - 1; ++i)
+            {
+                auto exact = evaluate (resultExpression, minValue + step * (i + 0.5));
+                auto interpolated = (table[static_cast<size_t> (i)] + table[static_cast<size_t> (i) + 1]) * 0.5;
+                maxError = std::max (maxError, std::abs (exact - interpolated));
+            }
+
+            parameter.isConstant = false;
+            parameter.initialValue.reset();
+
+            replaceBody (table, minValue, (tableSize - 1) / (maxValue - minValue));
+
+            emitMessage (Errors::lookupTableAccuracy (function.getName(), std::to_string (tableSize), choc::text::floatToString (maxError))
+                           .withLocation (function.context.getFullLocation()));
+        }
+
+        AST::Function& function;
+        const AST::Annotation& annotation;
+        AST::VariableDeclaration& parameter;
+        const AST::TypeBase& parameterType;
+        const AST::TypeBase& returnType;
+
+    private:
+        int32_t getTableSize() const
+        {
+            auto size = annotation.findConstantProperty ("lut");
+
+            if (size == nullptr)
+                throwError (annotation, Errors::unresolvedAnnotation());
+
+            if (size->getResultType()->isPrimitiveBool())
+                return defaultTableSize;
+
+            auto numPoints = size->getAsInt32();
+
+            if (! numPoints || *numPoints < 2 || *numPoints > maxTableSize)
+                throwError (annotation, Errors::lookupTableSizeOutOfRange (std::to_string (maxTableSize)));
+
+            return *numPoints;
+        }
+
+        double getRangeProperty (std::string_view name) const
+        {
+            if (auto value = annotation.findConstantProperty (name))
+                if (auto d = value->getAsFloat64())
+                    return *d;
+
+            throwError (annotation, Errors::lookupTableNeedsRange());
+        }
+
+        // The body must be a list of local constants followed by a return statement, so
+        // that the result can be calculated by the constant folder
+        const AST::ValueBase& getResultExpression() const
+        {
+            auto& block = *function.getMainBlock();
+
+            for (size_t i = 0; i < block.statements.size(); ++i)
+            {
+                auto& statement = block.statements[i].getObjectRef();
+                bool isLast = (i == block.statements.size() - 1);
+
+                if (auto v = statement.getAsVariableDeclaration())
+                    if (! isLast && v->isConstant && v->initialValue != nullptr)
+                        continue;
+
+                if (auto r = statement.getAsReturnStatement())
+                    if (isLast && r->value != nullptr)
+                        return AST::castToValueRef (r->value);
+
+                break;
+            }
+
+            throwError (function, Errors::cannotEvaluateForLookupTable());
+        }
+
+        double evaluate (const AST::ValueBase& resultExpression, double input)
+        {
+            parameter.isConstant = true;
+            parameter.initialValue.setChildObject (createConstant (parameterType, input));
+
+            if (auto result = resultExpression.constantFold())
+                if (auto d = result->getAsFloat64())
+                    return *d;
+
+            throwError (function, Errors::cannotEvaluateForLookupTable());
+        }
+
+        AST::ConstantValueBase& createConstant (const AST::TypeBase& type, double value)
+        {
+            if (type.isPrimitiveFloat32())
+                return function.context.allocator.createConstantFloat32 (static_cast<float> (value));
+
+            return function.context.allocator.createConstantFloat64 (value);
+        }
+
+        void replaceBody (const std::vector<double>& table, double minValue, double scale)
+        {
+            auto& block = function.allocateChild<AST::ScopeBlock>();
+            auto& allocator = function.context.allocator;
+
+            auto& tableData = block.context.allocate<AST::ConstantAggregate>();
+            tableData.type.setChildObject (AST::createArrayOfType (tableData, returnType, static_cast<int32_t> (table.size())));
+
+            for (auto value : table)
+                tableData.values.addChildObject (createConstant (returnType, value));
+
+            auto& tableVariable = AST::createLocalVariable (block, "_table", tableData);
+            tableVariable.isConstant = true;
+
+            auto getRef = [&] (AST::VariableDeclaration& v) -> AST::VariableReference&
+            {
+                return AST::createVariableReference (block.context, v);
+            };
+
+            auto addLocal = [&] (std::string_view name, const AST::TypeBase& type, AST::ValueBase& value) -> AST::VariableDeclaration&
+            {
+                auto& v = AST::createLocalVariable (block, name, type, value);
+                v.isConstant = true;
+                return v;
+            };
+
+            auto& position = addLocal ("_position", parameterType,
+                                       AST::createMultiply (block.context,
+                                                            AST::createSubtract (block.context,
+                                                                                 getRef (parameter),
+                                                                                 createConstant (parameterType, minValue)),
+                                                            createConstant (parameterType, scale)));
+
+            auto lastIndex = static_cast<double> (table.size() - 2);
+
+            // NaNs fail both comparisons and end up at index 0, so the index can never be out of range
+            auto& clamped = addLocal ("_clamped", parameterType,
+                                      AST::createTernary (block.context,
+                                                          AST::createBinaryOp (block.context, AST::BinaryOpTypeEnum::Enum::greaterThanOrEqual,
+                                                                               getRef (position), createConstant (parameterType, 0)),
+                                                          AST::createTernary (block.context,
+                                                                              AST::createBinaryOp (block.context, AST::BinaryOpTypeEnum::Enum::lessThanOrEqual,
+                                                                                                   getRef (position), createConstant (parameterType, lastIndex)),
+                                                                              getRef (position), createConstant (parameterType, lastIndex)),
+                                                          createConstant (parameterType, 0)));
+
+            auto& index = addLocal ("_index", allocator.int32Type,
+                                    AST::createCast (allocator.int32Type, getRef (clamped)));
+
+            auto& fraction = addLocal ("_fraction", returnType,
+                                       AST::createCastIfNeeded (returnType,
+                                                                AST::createSubtract (block.context,
+                                                                                     getRef (clamped),
+                                                                                     AST::createCast (parameterType, getRef (index)))));
+
+            auto getTableElement = [&] (int32_t offset) -> AST::Expression&
+            {
+                if (offset == 0)
+                    return AST::createGetElement (block.context, getRef (tableVariable), getRef (index));
+
+                return AST::createGetElement (block.context, getRef (tableVariable),
+                                              AST::createAdd (block.context, getRef (index), allocator.createConstantInt32 (offset)));
+            };
+
+            auto& result = AST::createAdd (block.context,
+                                           getTableElement (0),
+                                           AST::createMultiply (block.context,
+                                                                AST::createSubtract (block.context, getTableElement (1), getTableElement (0)),
+                                                                getRef (fraction)));
+
+            auto& returnStatement = block.allocateChild<AST::ReturnStatement>();
+            returnStatement.value.setChildObject (result);
+            block.addStatement (returnStatement);
+
+            function.mainBlock.setChildObject (block);
+        }
+    };
+
+    program.visitAllModules (true, [] (AST::ModuleBase& module)
+    {
+        for (auto& f : module.functions.iterateAs<AST::Function>())
+        {
+            if (auto annotation = AST::castTo<AST::Annotation> (f.annotation))
+            {
+                if (annotation->findProperty ("lut") == nullptr)
+                    continue;
+
+                if (f.getNumParameters() != 1 || f.getMainBlock() == nullptr
+                     || ! AST::castToTypeBaseRef (f.getParameter (0).declaredType).skipConstAndRefModifiers().isPrimitiveFloat()
+                     || ! AST::castToTypeBaseRef (f.returnType).skipConstAndRefModifiers().isPrimitiveFloat())
+                    throwError (*annotation, Errors::lookupTableNeedsFloatFunction());
+
+                LookupTableBuilder (f, *annotation).build();
+            }
+        }
+    });
+}
+
+}
@@ -33,6 +33,9 @@ static void mergeNamespaces (AST::Namespace& target, AST::Namespace& source)
     if (source.isSystem)
         target.isSystem = true;
 
+    if (! source.isPreResolved)
+        target.isPreResolved = false;
+
     if (source.comment != nullptr)
         if (target.getComment() == nullptr || target.getComment()->getContent().empty())
             target.comment.referTo (source.comment.get());
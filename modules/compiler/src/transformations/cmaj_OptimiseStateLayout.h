@@ -0,0 +1,215 @@
+//
+//     ,ad888ba,                              88
+//    d8"'    "8b
+//   d8            88,dba,,adba,   ,aPP8A.A8  88     The Cmajor Toolkit
+//   Y8,           88    88    88  88     88  88
+//    Y8a.   .a8P  88    88    88  88,   ,88  88     (C)2024 Cmajor Software Ltd
+//     '"Y888Y"'   88    88    88  '"8bbP"Y8  88     https://cmajor.dev
+//                                           ,88
+//                                        888P"
+//
+//  The Cmajor project is subject to commercial or open-source licensing.
+//  You may use it under the terms of the GPLv3 (see www.gnu.org/licenses), or
+//  visit https://cmajor.dev to learn about our commercial licence options.
+//
+//  CMAJOR IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+//  EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+//  DISCLAIMED.
+
+#pragma once
+
+namespace cmaj::transformations
+{
+
+//==============================================================================
+/// Works out how the members of the processor state structs will be laid out in
+/// memory, and re-orders them so that the small scalar values which are touched
+/// on every frame sit together at the start of the struct, with large buffers
+/// (e.g. delay lines) moved to the end.
+struct StateLayout
+{
+    /// Members bigger than this are treated as buffers and moved to the end of the state.
+    static constexpr uint64_t maxSmallMemberSize = 64;
+    static constexpr uint64_t maxAlignment = 64;
+
+    using SizeAndAlignment = TypeSizeAndAlignment;
+
+    /// Returns the size and alignment a type would have using the natural C layout rules.
+    /// This is only an estimate of what a particular backend will do, so it's used to
+    /// choose the member order, but the report asks the backend for its real layout.
+    static SizeAndAlignment getNaturalLayout (const AST::TypeBase& t, bool alignVectors = true)
+    {
+        auto& type = t.skipConstAndRefModifiers();
+
+        if (type.isPrimitiveBool())
+            return { 1, 1 };
+
+        if (auto v = type.getAsVectorType())
+        {
+            auto element = getNaturalLayout (*v->getArrayOrVectorElementType(), alignVectors);
+            auto size = element.size * static_cast<uint64_t> (v->resolveSize());
+
+            if (! alignVectors)
+                return { size, element.alignment };
+
+            auto alignment = std::min (maxAlignment, getNextPowerOf2 (size));
+            return { roundUp (size, alignment), alignment };
+        }
+
+        if (auto a = type.getAsArrayType())
+        {
+            auto element = getNaturalLayout (*a->getArrayOrVectorElementType(), alignVectors);
+            return { element.size * static_cast<uint64_t> (a->getFixedSizeAggregateNumElements()), element.alignment };
+        }
+
+        if (auto s = type.getAsStructType())
+        {
+            SizeAndAlignment result;
+
+            for (auto& m : s->memberTypes)
+            {
+                auto member = getNaturalLayout (AST::castToTypeBaseRef (m), alignVectors);
+                result.size = roundUp (result.size, member.alignment) + member.size;
+                result.alignment = std::max (result.alignment, member.alignment);
+            }
+
+            result.size = roundUp (result.size, result.alignment);
+            return result;
+        }
+
+        auto size = static_cast<uint64_t> (type.getPackedStorageSize());
+        return { size, std::max<uint64_t> (1, std::min<uint64_t> (8, getNextPowerOf2 (size))) };
+    }
+
+    //==============================================================================
+    static void optimiseMemberOrder (AST::StructType& s)
+    {
+        auto numMembers = s.memberNames.size();
+        std::vector<size_t> order;
+        std::vector<SizeAndAlignment> layouts;
+
+        for (size_t i = 0; i < numMembers; ++i)
+        {
+            order.push_back (i);
+            layouts.push_back (getNaturalLayout (s.getMemberType (i)));
+        }
+
+        std::stable_sort (order.begin(), order.end(), [&] (size_t a, size_t b)
+        {
+            auto& layoutA = layouts[a];
+            auto& layoutB = layouts[b];
+            bool isSmallA = layoutA.size <= maxSmallMemberSize;
+            bool isSmallB = layoutB.size <= maxSmallMemberSize;
+
+            if (isSmallA != isSmallB)
+                return isSmallA;
+
+            // Small members are packed by decreasing alignment to avoid padding, and the
+            // buffers ordered by size so that the biggest ones are furthest from the hot data
+            if (isSmallA)
+                return layoutA.alignment > layoutB.alignment;
+
+            return layoutA.size < layoutB.size;
+        });
+
+        auto names = s.memberNames.get();
+        auto types = s.memberTypes.get();
+
+        for (size_t i = 0; i < numMembers; ++i)
+        {
+            s.memberNames.set (names[order[i]], i);
+            s.memberTypes.set (types[order[i]], i);
+        }
+    }
+
+    //==============================================================================
+    /// Returns a JSON object listing the offset and size of every variable in the main
+    /// processor's state, with the state of any flattened graph nodes expanded in-place.
+    /// The sizes and alignments come from the backend, and the members are placed using
+    /// the usual struct rules, which is what all the backends do with them.
+    static choc::value::Value createReport (const AST::ProcessorBase& mainProcessor, const GetTypeSizeAndAlignment& getLayout)
+    {
+        auto variables = choc::value::createEmptyArray();
+        uint64_t totalSize = 0;
+
+        if (auto stateStruct = getStateStruct (mainProcessor))
+        {
+            addVariablesToReport (variables, *stateStruct, mainProcessor, {}, 0, getLayout);
+            totalSize = getLayout (*stateStruct).size;
+        }
+
+        return choc::json::create ("processor", mainProcessor.getFullyQualifiedReadableName(),
+                                   "stateSize", static_cast<int64_t> (totalSize),
+                                   "variables", variables);
+    }
+
+private:
+    static uint64_t roundUp (uint64_t size, uint64_t alignment)
+    {
+        return ((size + alignment - 1) / alignment) * alignment;
+    }
+
+    static uint64_t getNextPowerOf2 (uint64_t n)
+    {
+        uint64_t result = 1;
+
+        while (result < n)
+            result <<= 1;
+
+        return result;
+    }
+
+    static ptr<AST::StructType> getStateStruct (const AST::ProcessorBase& processor)
+    {
+        return processor.findStruct (processor.getStrings().stateStructName);
+    }
+
+    static void addVariablesToReport (choc::value::Value& variables, const AST::StructType& stateStruct,
+                                      const AST::ProcessorBase& processor, const std::string& namePrefix, uint64_t baseOffset,
+                                      const GetTypeSizeAndAlignment& getLayout)
+    {
+        uint64_t offset = 0;
+
+        for (size_t i = 0; i < stateStruct.memberNames.size(); ++i)
+        {
+            auto& memberType = stateStruct.getMemberType (i).skipConstAndRefModifiers();
+            auto layout = getLayout (memberType);
+            offset = roundUp (offset, layout.alignment);
+            auto name = namePrefix + std::string (stateStruct.getMemberName (i).get());
+
+            // A member which holds the state of a flattened graph node is expanded, so that
+            // each variable is attributed to the processor that declared it
+            if (auto nestedStruct = memberType.getAsStructType())
+            {
+                if (auto nodeProcessor = nestedStruct->findParentProcessor())
+                {
+                    if (getStateStruct (*nodeProcessor).get() == nestedStruct)
+                    {
+                        addVariablesToReport (variables, *nestedStruct, *nodeProcessor, name + ".", baseOffset + offset, getLayout);
+                        offset += layout.size;
+                        continue;
+                    }
+                }
+            }
+
+            variables.addArrayElement (choc::json::create ("name", name,
+                                                           "processor", processor.getFullyQualifiedReadableName(),
+                                                           "offset", static_cast<int64_t> (baseOffset + offset),
+                                                           "size", static_cast<int64_t> (layout.size)));
+            offset += layout.size;
+        }
+    }
+};
+
+//==============================================================================
+static inline void optimiseStateLayout (AST::Program& program)
+{
+    program.visitAllModules (true, [] (AST::ModuleBase& module)
+    {
+        if (auto processor = module.getAsProcessorBase())
+            if (auto stateStruct = processor->findStruct (processor->getStrings().stateStructName))
+                StateLayout::optimiseMemberOrder (*stateStruct);
+    });
+}
+
+}
@@ -0,0 +1,192 @@
+//
+//     ,ad888ba,                              88
+//    d8"'    "8b
+//   d8            88,dba,,adba,   ,aPP8A.A8  88     The Cmajor Toolkit
+//   Y8,           88    88    88  88     88  88
+//    Y8a.   .a8P  88    88    88  88,   ,88  88     (C)2024 Cmajor Software Ltd
+//     '"Y888Y"'   88    88    88  '"8bbP"Y8  88     https://cmajor.dev
+//                                           ,88
+//                                        888P"
+//
+//  The Cmajor project is subject to commercial or open-source licensing.
+//  You may use it under the terms of the GPLv3 (see www.gnu.org/licenses), or
+//  visit https://cmajor.dev to learn about our commercial licence options.
+//
+//  CMAJOR IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+//  EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+//  DISCLAIMED.
+
+
+namespace cmaj::transformations
+{
+
+//==============================================================================
+/// When a build's mathsApproximationLevel is non-zero, this redirects calls to the
+/// transcendental intrinsics to the polynomial approximations in the namespace
+/// std::intrinsics::internal::approximations. Doing this to the AST means that every
+/// backend ends up running the same code. Calls which take vectors are sent to a
+/// generated function that applies the scalar approximation to each element.
+inline void replaceIntrinsicsWithApproximations (AST::Program& program, int approximationLevel)
+{
+    if (approximationLevel <= 0)
+        return;
+
+    struct ReplaceIntrinsicsWithApproximations  : public AST::NonParameterisedObjectVisitor
+    {
+        using super = AST::NonParameterisedObjectVisitor;
+        using super::visit;
+
+        ReplaceIntrinsicsWithApproximations (AST::Allocator& a, AST::ModuleBase& ns)
+            : super (a), approximations (ns) {}
+
+        CMAJ_DO_NOT_VISIT_CONSTANTS
+
+        void visit (AST::FunctionCall& fc) override
+        {
+            super::visit (fc);
+
+            auto name = getApproximationName (fc.getIntrinsicType());
+
+            if (name.empty())
+                return;
+
+            if (auto originalFunction = fc.getTargetFunction())
+            {
+                auto& argType = originalFunction->getParameterTypes().front()->skipConstAndRefModifiers();
+                auto numArgs = originalFunction->getNumParameters();
+                ptr<AST::Function> replacement;
+
+                if (argType.isPrimitiveFloat())
+                    replacement = findScalarFunction (name, argType);
+                else if (auto vectorType = argType.getAsVectorType())
+                    if (vectorType->getElementType().isPrimitiveFloat())
+                        replacement = getOrCreateVectorFunction (name, *vectorType, numArgs);
+
+                if (replacement != nullptr)
+                {
+                    fc.intrinsicType.reset();
+                    fc.targetFunction.referTo (*replacement);
+                }
+            }
+        }
+
+        static std::string_view getApproximationName (AST::Intrinsic::Type intrin)
+        {
+            switch (intrin)
+            {
+                case AST::Intrinsic::Type::sin:     return "sin";
+                case AST::Intrinsic::Type::cos:     return "cos";
+                case AST::Intrinsic::Type::tan:     return "tan";
+                case AST::Intrinsic::Type::exp:     return "exp";
+                case AST::Intrinsic::Type::log:     return "log";
+                case AST::Intrinsic::Type::log10:   return "log10";
+                case AST::Intrinsic::Type::pow:     return "pow";
+                case AST::Intrinsic::Type::sinh:    return "sinh";
+                case AST::Intrinsic::Type::cosh:    return "cosh";
+                case AST::Intrinsic::Type::tanh:    return "tanh";
+
+                case AST::Intrinsic::Type::isnan:
+                case AST::Intrinsic::Type::isinf:
+                case AST::Intrinsic::Type::sqrt:
+                case AST::Intrinsic::Type::abs:
+                case AST::Intrinsic::Type::min:
+                case AST::Intrinsic::Type::max:
+                case AST::Intrinsic::Type::floor:
+                case AST::Intrinsic::Type::ceil:
+                case AST::Intrinsic::Type::rint:
+                case AST::Intrinsic::Type::fmod:
+                case AST::Intrinsic::Type::reinterpretFloatToInt:
+                case AST::Intrinsic::Type::reinterpretIntToFloat:
+                case AST::Intrinsic::Type::select:
+                case AST::Intrinsic::Type::addModulo2Pi:
+                case AST::Intrinsic::Type::remainder:
+                case AST::Intrinsic::Type::clamp:
+                case AST::Intrinsic::Type::wrap:
+                case AST::Intrinsic::Type::asinh:
+                case AST::Intrinsic::Type::acosh:
+                case AST::Intrinsic::Type::atanh:
+                case AST::Intrinsic::Type::asin:
+                case AST::Intrinsic::Type::acos:
+                case AST::Intrinsic::Type::atan:
+                case AST::Intrinsic::Type::atan2:
+                case AST::Intrinsic::Type::unknown:
+                default:
+                    return {};
+            }
+        }
+
+        ptr<AST::Function> findScalarFunction (std::string_view name, const AST::TypeBase& type)
+        {
+            return approximations.findFunction ([&] (const AST::Function& f)
+            {
+                return f.getName().get() == name
+                        && AST::castToTypeBaseRef (f.getParameter (0).declaredType).isSameType (type, AST::TypeBase::ComparisonFlags::ignoreConst);
+            });
+        }
+
+        AST::Function& getOrCreateVectorFunction (std::string_view name, const AST::VectorType& vectorType, size_t numArgs)
+        {
+            auto& elementType = vectorType.getElementType();
+            auto numElements = static_cast<int32_t> (vectorType.resolveSize());
+
+            auto functionName = std::string (name) + (elementType.isPrimitiveFloat32() ? "_float32_vec" : "_float64_vec")
+                                  + std::to_string (numElements);
+
+            if (auto f = approximations.findFunction (functionName, numArgs))
+                return *f;
+
+            auto scalarFunction = findScalarFunction (name, elementType);
+            CMAJ_ASSERT (scalarFunction != nullptr);
+
+            auto& f = AST::createFunctionInModule (approximations, vectorType, functionName);
+            auto& block = *f.getMainBlock();
+            auto arg1 = AST::addFunctionParameter (f, vectorType, "a");
+            auto arg2 = numArgs > 1 ? AST::addFunctionParameter (f, vectorType, "b") : arg1;
+
+            auto& resultCast = block.allocateChild<AST::Cast>();
+            resultCast.targetType.createReferenceTo (vectorType);
+
+            auto getElement = [&] (const AST::VariableRefGenerator& arg, int32_t index) -> AST::GetElement&
+            {
+                return AST::createGetElement (block, static_cast<AST::VariableReference&> (arg), index);
+            };
+
+            for (int32_t i = 0; i < numElements; ++i)
+            {
+                if (numArgs > 1)
+                    resultCast.arguments.addReference (AST::createFunctionCall (block, *scalarFunction, getElement (arg1, i), getElement (arg2, i)));
+                else
+                    resultCast.arguments.addReference (AST::createFunctionCall (block, *scalarFunction, getElement (arg1, i)));
+            }
+
+            AST::addReturnStatement (block, resultCast);
+            return f;
+        }
+
+        AST::ModuleBase& approximations;
+    };
+
+    auto intrinsicsNamespace = findIntrinsicsNamespaceFromRoot (program.rootNamespace);
+    CMAJ_ASSERT (intrinsicsNamespace != nullptr);
+    auto& strings = intrinsicsNamespace->getStringPool();
+
+    auto findNestedModule = [&] (ptr<AST::ModuleBase> parent, std::string_view name) -> ptr<AST::ModuleBase>
+    {
+        if (parent != nullptr)
+            return parent->findChildModule (strings.get (name));
+
+        return {};
+    };
+
+    auto approximations = findNestedModule (findNestedModule (findNestedModule (intrinsicsNamespace, "internal"),
+                                                              "approximations"),
+                                            "level" + std::to_string (approximationLevel));
+
+    if (approximations == nullptr)
+        throwError (Errors::cannotFindMathsApproximations (std::to_string (approximationLevel)));
+
+    ReplaceIntrinsicsWithApproximations r (program.allocator, *approximations);
+    r.visit (program.rootNamespace);
+}
+
+}
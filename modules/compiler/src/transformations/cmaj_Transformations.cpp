@@ -25,6 +25,7 @@
 
 #include "../passes/cmaj_Passes.h"
 #include "../validation/cmaj_Validator.h"
+#include "../diagnostics/cmaj_CompileProfiler.h"
 
 #include "cmaj_Transformations.h"
 
@@ -57,27 +58,47 @@
 #include "cmaj_AddFallbackIntrinsics.h"
 #include "cmaj_ReplaceMultidimensionalArrays.h"
 #include "cmaj_ConvertLargeConstants.h"
+#include "cmaj_OptimiseStateLayout.h"
+#include "cmaj_CreateLookupTables.h"
+#include "cmaj_ReplaceIntrinsicsWithApproximations.h"
 
 namespace cmaj::transformations
 {
 
+template <typename PassType>
+static passes::PassResult runPass (std::string_view name, AST::Program& program, passes::ModuleWorklist& worklist, bool throwOnErrors)
+{
+    CompileProfiler::Scope profilerScope (name, "pass");
+    return passes::runPass<PassType> (program, worklist, throwOnErrors);
+}
+
+template <typename TransformationFn>
+static auto runTransformation (std::string_view name, TransformationFn&& transformation)
+{
+    CompileProfiler::Scope profilerScope (name, "transformation");
+    return transformation();
+}
+
 static void runResolutionPasses (AST::Program& program, bool throwOnErrors)
 {
+    CompileProfiler::Scope profilerScope ("runResolutionPasses", "pass");
+    passes::ModuleWorklist worklist (program);
+
     for (;;)
     {
         passes::PassResult result;
 
-        result += passes::runPass<passes::TypeResolver>             (program, throwOnErrors);
-        result += passes::runPass<passes::FunctionResolver>         (program, throwOnErrors);
-        result += passes::runPass<passes::NameResolver>             (program, throwOnErrors);
-        result += passes::runPass<passes::ModuleSpecialiser>        (program, throwOnErrors);
-        result += passes::runPass<passes::ProcessorResolver>        (program, throwOnErrors);
-        result += passes::runPass<passes::EndpointResolver>         (program, throwOnErrors);
-        result += passes::runPass<passes::ConstantFolder>           (program, throwOnErrors);
-        result += passes::runPass<passes::StrengthReduction>        (program, throwOnErrors);
-        result += passes::runPass<passes::ExternalResolver>         (program, throwOnErrors);
-
-        if (result.numChanges == 0)
+        result += runPass<passes::TypeResolver>        ("TypeResolver",        program, worklist, throwOnErrors);
+        result += runPass<passes::FunctionResolver>    ("FunctionResolver",    program, worklist, throwOnErrors);
+        result += runPass<passes::NameResolver>        ("NameResolver",        program, worklist, throwOnErrors);
+        result += runPass<passes::ModuleSpecialiser>   ("ModuleSpecialiser",   program, worklist, throwOnErrors);
+        result += runPass<passes::ProcessorResolver>   ("ProcessorResolver",   program, worklist, throwOnErrors);
+        result += runPass<passes::EndpointResolver>    ("EndpointResolver",    program, worklist, throwOnErrors);
+        result += runPass<passes::ConstantFolder>      ("ConstantFolder",      program, worklist, throwOnErrors);
+        result += runPass<passes::StrengthReduction>   ("StrengthReduction",   program, worklist, throwOnErrors);
+        result += runPass<passes::ExternalResolver>    ("ExternalResolver",    program, worklist, throwOnErrors);
+
+        if (! worklist.prepareNextSweep (result.numChanges))
             return;
     }
 }
@@ -85,10 +106,10 @@ static void runResolutionPasses (AST::Program& program, bool throwOnErrors)
 static void runFullResolutionAndChecks (AST::Program& program, uint64_t stackSizeLimit, bool allowTopLevelSlices, bool allowExternalFunctions)
 {
     runResolutionPasses (program, false);
-    passes::DuplicateNameCheckPass::check (program);
+    runTransformation ("DuplicateNameCheckPass", [&] { passes::DuplicateNameCheckPass::check (program); });
     runResolutionPasses (program, true);
 
-    validation::PostLink::check (program, stackSizeLimit, allowTopLevelSlices, allowExternalFunctions);
+    runTransformation ("PostLink::check", [&] { validation::PostLink::check (program, stackSizeLimit, allowTopLevelSlices, allowExternalFunctions); });
 }
 
 void runBasicResolutionPasses (AST::Program& program)
@@ -100,10 +121,10 @@ void prepareForResolution (AST::Program& program, uint64_t stackSizeLimit)
 {
     runResolutionPasses (program, false);
 
-    if (! validation::PostLoad::check (program))
+    if (! runTransformation ("PostLoad::check", [&] { return validation::PostLoad::check (program); }))
         runFullResolutionAndChecks (program, stackSizeLimit, false, true);
 
-    createHoistedEndpointConnections (program);
+    runTransformation ("createHoistedEndpointConnections", [&] { createHoistedEndpointConnections (program); });
 }
 
 void prepareForCodeGen (AST::Program& program,
@@ -118,47 +139,70 @@ void prepareForCodeGen (AST::Program& program,
 {
     CMAJ_ASSERT (buildSettings.getMaxBlockSize() != 0 && buildSettings.getEventBufferSize() != 0);
 
-    cloneGraphNodes (program);
+    runTransformation ("cloneGraphNodes", [&] { cloneGraphNodes (program); });
 
-    auto processorReplacementState = replaceProcessorProperties (program, buildSettings.getMaxFrequency(), buildSettings.getFrequency(), useDynamicSampleRate);
+    auto replaceProperties = [&]
+    {
+        return runTransformation ("replaceProcessorProperties", [&]
+        {
+            return replaceProcessorProperties (program, buildSettings.getMaxFrequency(), buildSettings.getFrequency(), useDynamicSampleRate);
+        });
+    };
+
+    auto processorReplacementState = replaceProperties();
 
     while (processorReplacementState.propertiesReplaced != 0)
     {
         runFullResolutionAndChecks (program, buildSettings.getMaxStackSize(), allowTopLevelSlices, allowExternalFunctions);
-        processorReplacementState = replaceProcessorProperties (program, buildSettings.getMaxFrequency(), buildSettings.getFrequency(), useDynamicSampleRate);
+        processorReplacementState = replaceProperties();
     }
 
     runFullResolutionAndChecks (program, buildSettings.getMaxStackSize(), allowTopLevelSlices, allowExternalFunctions);
-    simplifyGraphConnections (program);
+    runTransformation ("simplifyGraphConnections",             [&] { simplifyGraphConnections (program); });
     runResolutionPasses (program, allowTopLevelSlices);
 
     resultLatency = program.getMainProcessor().getLatency();
 
-    determineFunctionAliasStatus (program);
-    removeUnusedNodes (program);
-    removeGenericAndParameterisedObjects (program);
-    removeUnusedEndpoints (program, isEndpointActive);
+    runTransformation ("determineFunctionAliasStatus",         [&] { determineFunctionAliasStatus (program); });
+    runTransformation ("removeUnusedNodes",                    [&] { removeUnusedNodes (program); });
+    runTransformation ("removeGenericAndParameterisedObjects", [&] { removeGenericAndParameterisedObjects (program); });
+    runTransformation ("removeUnusedEndpoints",                [&] { removeUnusedEndpoints (program, isEndpointActive); });
     runResolutionPasses (program, allowTopLevelSlices);
-    convertComplexTypes (program);
-    addFallbackIntrinsics (program, engineSupportsIntrinsic);
-    canonicaliseLoopsAndBlocks (program);
-    replaceWrapTypesAndLoopCounters (program);
-    replaceMultidimensionalArrays (program);
-    convertUnwrittenVariablesToConst (program);
-    inlineAllCallsWhichAdvance (program);
-    createSystemInitFunctions (program, processorReplacementState.sessionIDVariable, processorReplacementState.frequencyVariable);
-    convertLargeConstantsToGlobals (program);
-    flattenGraph (program, buildSettings.getMaxBlockSize(), buildSettings.getEventBufferSize(), useForwardBranchesForAdvance);
+    runTransformation ("convertComplexTypes",                  [&] { convertComplexTypes (program); });
+    runTransformation ("createLookupTables",                   [&] { createLookupTables (program); });
+    runTransformation ("replaceIntrinsicsWithApproximations",  [&] { replaceIntrinsicsWithApproximations (program, buildSettings.getMathsApproximationLevel()); });
+    runTransformation ("addFallbackIntrinsics",                [&] { addFallbackIntrinsics (program, engineSupportsIntrinsic); });
+    runTransformation ("canonicaliseLoopsAndBlocks",           [&] { canonicaliseLoopsAndBlocks (program); });
+    runTransformation ("replaceWrapTypesAndLoopCounters",      [&] { replaceWrapTypesAndLoopCounters (program); });
+    runTransformation ("replaceMultidimensionalArrays",        [&] { replaceMultidimensionalArrays (program); });
+    runTransformation ("convertUnwrittenVariablesToConst",     [&] { convertUnwrittenVariablesToConst (program); });
+    runTransformation ("inlineAllCallsWhichAdvance",           [&] { inlineAllCallsWhichAdvance (program); });
+    runTransformation ("createSystemInitFunctions",            [&] { createSystemInitFunctions (program, processorReplacementState.sessionIDVariable,
+                                                                                                        processorReplacementState.frequencyVariable); });
+    runTransformation ("convertLargeConstantsToGlobals",       [&] { convertLargeConstantsToGlobals (program); });
+    runTransformation ("flattenGraph",                         [&] { flattenGraph (program, buildSettings.getMaxBlockSize(), buildSettings.getEventBufferSize(),
+                                                                                   useForwardBranchesForAdvance); });
+    runTransformation ("optimiseStateLayout",                  [&] { optimiseStateLayout (program); });
+}
+
+TypeSizeAndAlignment getNaturalTypeLayout (const AST::TypeBase& type, bool alignVectors)
+{
+    return StateLayout::getNaturalLayout (type, alignVectors);
+}
+
+choc::value::Value createStateLayoutReport (const AST::Program& program, const GetTypeSizeAndAlignment& getLayout)
+{
+    return StateLayout::createReport (program.getMainProcessor(), getLayout);
 }
 
 void prepareForGraphGen (AST::Program& program,
                          double frequency,
                          uint64_t stackSizeLimit)
 {
-    cloneGraphNodes (program);
-    replaceProcessorProperties (program, frequency, frequency, false);
+    runTransformation ("cloneGraphNodes",            [&] { cloneGraphNodes (program); });
+    runTransformation ("replaceProcessorProperties", [&] { replaceProcessorProperties (program, frequency, frequency, false); });
     runFullResolutionAndChecks (program, stackSizeLimit, true, true);
-    simplifyGraphConnections (program);
+    runTransformation ("simplifyGraphConnections",   [&] { simplifyGraphConnections (program); });
     runResolutionPasses (program, true);
 }
 
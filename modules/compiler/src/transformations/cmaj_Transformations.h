@@ -40,6 +40,24 @@ namespace cmaj::transformations
                             double& resultLatency,
                             const std::function<bool(const EndpointID&)>& isEndpointActive);
 
+    /// The size and alignment that a backend gives to a type in memory.
+    struct TypeSizeAndAlignment
+    {
+        uint64_t size = 0, alignment = 1;
+    };
+
+    using GetTypeSizeAndAlignment = std::function<TypeSizeAndAlignment(const AST::TypeBase&)>;
+
+    /// Returns the size and alignment a type has under the natural C layout rules. If
+    /// alignVectors is true, vectors are aligned to their size as SIMD types are, otherwise
+    /// they're laid out like arrays.
+    TypeSizeAndAlignment getNaturalTypeLayout (const AST::TypeBase&, bool alignVectors);
+
+    /// Returns a JSON description of the size and offset of each variable in the main
+    /// processor's state, using the backend's own type layouts. This must be called
+    /// after prepareForCodeGen().
+    choc::value::Value createStateLayoutReport (const AST::Program&, const GetTypeSizeAndAlignment&);
+
     // Run passes for graph generation
     void prepareForGraphGen (AST::Program&,
                              double frequency,
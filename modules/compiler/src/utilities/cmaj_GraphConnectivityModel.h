@@ -140,14 +140,39 @@ struct GraphConnectivityModel
 
     void addConnection (const AST::Connection& c)
     {
+        // A delayed connection can't be part of a cycle, but the nodes at either end of it
+        // share the delay line's state, so getExecutionStages() needs to know about it
         if (c.delayLength != nullptr)
+        {
+            visitNodeConnections (c, nullptr, [this] (ptr<const AST::GraphNode> source, ptr<const AST::GraphNode> dest,
+                                                      const AST::EndpointInstance&, const AST::EndpointInstance&)
+            {
+                if (source != nullptr && dest != nullptr)
+                    delayedConnections.push_back ({ getNodeIndex (source), getNodeIndex (dest) });
+            });
+
             return;
+        }
 
+        visitNodeConnections (c,
+                              [this] (const AST::Connection& conn) { addConnection (conn); },
+                              [this, &c] (ptr<const AST::GraphNode> source, ptr<const AST::GraphNode> dest,
+                                          const AST::EndpointInstance& sourceEndpoint, const AST::EndpointInstance& destEndpoint)
+                              {
+                                  addConnection (c, source, dest, sourceEndpoint, destEndpoint);
+                              });
+    }
+
+    template <typename HandleNestedConnection, typename HandleNodes>
+    static void visitNodeConnections (const AST::Connection& c, HandleNestedConnection&& handleNestedConnection, HandleNodes&& handleNodes)
+    {
         for (auto& source : c.sources)
         {
             if (auto conn = AST::castToSkippingReferences<AST::Connection> (source))
             {
-                addConnection (*conn);
+                if constexpr (! std::is_same_v<std::decay_t<HandleNestedConnection>, std::nullptr_t>)
+                    handleNestedConnection (*conn);
+
                 continue;
             }
 
@@ -157,8 +182,8 @@ struct GraphConnectivityModel
             {
                 if (auto value = AST::castToSkippingReferences<AST::ValueBase> (element->parent))
                     sourceEndpoints = getUsedEndpointInstances (*value);
-                else
-                    sourceEndpoints.push_back (*AST::castToSkippingReferences<AST::EndpointInstance> (element->parent));
+                else if (auto instance = AST::castToSkippingReferences<AST::EndpointInstance> (element->parent))
+                    sourceEndpoints.push_back (*instance);
             }
             else if (auto instance = AST::castToSkippingReferences<AST::EndpointInstance> (source))
             {
@@ -186,8 +211,11 @@ struct GraphConnectivityModel
                     else
                         destEndpoint = AST::castToSkippingReferences<AST::EndpointInstance> (dest);
 
+                    if (destEndpoint == nullptr)
+                        continue;
+
                     auto destNode = AST::castToSkippingReferences<AST::GraphNode> (destEndpoint->node);
-                    addConnection (c, sourceNode, destNode, sourceEndpoint, *destEndpoint);
+                    handleNodes (sourceNode, destNode, sourceEndpoint, *destEndpoint);
                 }
             }
         }
@@ -229,6 +257,36 @@ struct GraphConnectivityModel
         }
     }
 
+    /// Divides the nodes into a sequence of stages, where every node only depends on nodes
+    /// in earlier stages, so that the nodes within a stage are independent of each other.
+    /// Both ends of a delayed connection use the delay line's state, so its destination is
+    /// placed after its source, unless it's a feedback path, in which case the source already
+    /// comes after the destination. A cycle without a delay is an error which the validator
+    /// reports, so here it's just broken at an arbitrary point.
+    std::vector<std::vector<const AST::GraphNode*>> getExecutionStages() const
+    {
+        std::vector<std::vector<size_t>> delayedSources (nodes.size());
+
+        for (auto& [source, dest] : delayedConnections)
+            if (source != dest && ! dependsOn (source, dest, delayedSources))
+                delayedSources[dest].push_back (source);
+
+        std::vector<std::vector<const AST::GraphNode*>> stages;
+        std::vector<int> nodeStages (nodes.size(), stageNotYetFound);
+
+        for (size_t i = 0; i < nodes.size(); ++i)
+        {
+            auto stage = static_cast<size_t> (findExecutionStage (i, nodeStages, delayedSources));
+
+            if (stages.size() <= stage)
+                stages.resize (stage + 1);
+
+            stages[stage].push_back (std::addressof (nodes[i].node));
+        }
+
+        return stages;
+    }
+
     double calculateTotalDelay()
     {
         double longest = 0;
@@ -265,6 +323,74 @@ private:
         return *n;
     }
 
+    std::vector<std::pair<size_t, size_t>> delayedConnections;
+
+    static constexpr int stageNotYetFound = -1, stageBeingFound = -2;
+
+    size_t getNodeIndex (ptr<const AST::GraphNode> node)
+    {
+        return static_cast<size_t> (std::addressof (getNode (node)) - nodes.data());
+    }
+
+    size_t getNodeIndex (const Node& node) const
+    {
+        return static_cast<size_t> (std::addressof (node) - nodes.data());
+    }
+
+    template <typename VisitFn>
+    void visitSources (size_t nodeIndex, const std::vector<std::vector<size_t>>& delayedSources, VisitFn&& visit) const
+    {
+        for (auto& source : nodes[nodeIndex].sources)
+            if (source.node)
+                visit (getNodeIndex (*source.node));
+
+        for (auto source : delayedSources[nodeIndex])
+            visit (source);
+    }
+
+    bool dependsOn (size_t nodeIndex, size_t possibleSource, const std::vector<std::vector<size_t>>& delayedSources) const
+    {
+        std::vector<bool> visited (nodes.size());
+        std::vector<size_t> toVisit { nodeIndex };
+
+        while (! toVisit.empty())
+        {
+            auto next = toVisit.back();
+            toVisit.pop_back();
+
+            if (next == possibleSource)
+                return true;
+
+            if (! visited[next])
+            {
+                visited[next] = true;
+                visitSources (next, delayedSources, [&] (size_t source) { toVisit.push_back (source); });
+            }
+        }
+
+        return false;
+    }
+
+    int findExecutionStage (size_t nodeIndex, std::vector<int>& nodeStages, const std::vector<std::vector<size_t>>& delayedSources) const
+    {
+        if (nodeStages[nodeIndex] == stageBeingFound)
+            return -1;
+
+        if (nodeStages[nodeIndex] != stageNotYetFound)
+            return nodeStages[nodeIndex];
+
+        nodeStages[nodeIndex] = stageBeingFound;
+        int stage = 0;
+
+        visitSources (nodeIndex, delayedSources, [&] (size_t source)
+        {
+            stage = std::max (stage, 1 + findExecutionStage (source, nodeStages, delayedSources));
+        });
+
+        nodeStages[nodeIndex] = stage;
+        return stage;
+    }
+
     static std::string getCycleNameList (choc::span<const Node*> visited)
     {
         std::vector<std::string> names;
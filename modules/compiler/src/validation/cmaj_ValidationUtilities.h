@@ -645,6 +645,18 @@ static inline void checkAnnotation (const AST::Annotation& a)
         if (val == nullptr || getAsFoldedConstant (*val) == nullptr)
             throwError (v, Errors::unresolvedAnnotation());
     }
+
+    if (auto level = a.findConstantProperty ("optimise"))
+    {
+        auto n = level->getAsInt32();
+
+        if (! level->getResultType()->isPrimitiveInt() || ! n || *n < 0 || *n > 4)
+            throwError (*a.findProperty ("optimise"), Errors::optimiseAnnotationOutOfRange());
+    }
+
+    if (auto fastMaths = a.findConstantProperty ("fastmath"))
+        if (! fastMaths->getResultType()->isPrimitiveBool())
+            throwError (*a.findProperty ("fastmath"), Errors::fastmathAnnotationMustBeBool());
 }
 
 static bool containsVoidType (const AST::TypeBase& type)
@@ -19,6 +19,7 @@
 #include <future>
 #include <iomanip>
 #include <optional>
+#include <mutex>
 
 #include "../../compiler/include/cmaj_ErrorHandling.h"
 #include "../include/cmaj_ScriptEngine.h"
@@ -26,6 +27,7 @@
 #include "choc/audio/choc_MIDIFile.h"
 #include "cmaj_javascript_ObjectHandle.h"
 #include "cmaj_javascript_Helpers.h"
+#include "../../../include/cmajor/helpers/cmaj_ThreadPools.h"
 
 #ifdef CHOC_WINDOWS
  #include <io.h>
@@ -33,6 +35,10 @@
  #include <unistd.h>
 #endif
 
+#ifdef CHOC_OSX
+ #include <mach/mach.h>
+#endif
+
 
 //==============================================================================
 namespace cmaj::test
@@ -69,7 +75,7 @@ namespace cmaj::test
 
         void runTests (std::ostream& console,
                        const cmaj::BuildSettings& buildSettings, std::optional<int> testToRun,
-                       bool runDisabled, const choc::value::Value& engineOptions,
+                       bool runDisabled, bool updateBaselines, const choc::value::Value& engineOptions,
                        std::string testScriptPath);
 
         bool needsResaving() const
@@ -302,40 +308,6 @@ namespace cmaj::test
         }
     };
 
-    //==============================================================================
-    struct ThreadPool
-    {
-        ThreadPool (uint32_t threads) : availableThreads (threads)
-        {}
-
-        void acquire()
-        {
-            std::unique_lock<std::mutex> lock (mutex);
-            cv.wait (lock, [this] { return availableThreads != 0; });
-            availableThreads--;
-        }
-
-        void release()
-        {
-            std::unique_lock<std::mutex> lock (mutex);
-            availableThreads++;
-            cv.notify_one();
-        }
-
-    private:
-        std::mutex mutex;
-        std::condition_variable cv;
-        uint32_t availableThreads;
-    };
-
-    struct ThreadAllocator
-    {
-        ThreadAllocator (ThreadPool& p) : pool (p)    { pool.acquire(); }
-        ~ThreadAllocator()                            { pool.release(); }
-
-        ThreadPool& pool;
-    };
-
     //==============================================================================
     struct TestResult
     {
@@ -449,9 +421,11 @@ namespace cmaj::test
                               TestSuite& suite,
                               std::ostream& out,
                               const choc::value::Value& engineOptions,
-                              std::string testScriptPathToUse)
+                              std::string testScriptPathToUse,
+                              bool shouldUpdateBaselines)
            : testFile (suite.filename), output (out),
-             defaultEngineOptions (engineOptions), testScriptPath (std::move (testScriptPathToUse))
+             defaultEngineOptions (engineOptions), updateBaselines (shouldUpdateBaselines),
+             testScriptPath (std::move (testScriptPathToUse))
         {
             javascriptEngine = std::make_shared<javascript::JavascriptEngine> (buildSettings.setFrequency (44100),
                                                                                engineOptions);
@@ -461,6 +435,8 @@ namespace cmaj::test
             CMAJ_JAVASCRIPT_BINDING_METHOD (getCurrentTestSection)
             CMAJ_JAVASCRIPT_BINDING_METHOD (getDefaultEngineOptions)
             CMAJ_JAVASCRIPT_BINDING_METHOD (getEngineName)
+            CMAJ_JAVASCRIPT_BINDING_METHOD (getMemoryUsage)
+            CMAJ_JAVASCRIPT_BINDING_METHOD (shouldUpdateBaselines)
             CMAJ_JAVASCRIPT_BINDING_METHOD (testReportFail)
             CMAJ_JAVASCRIPT_BINDING_METHOD (testReportSuccess)
             CMAJ_JAVASCRIPT_BINDING_METHOD (testReportDisabled)
@@ -474,6 +450,8 @@ namespace cmaj::test
             CMAJ_JAVASCRIPT_BINDING_METHOD (testWriteStreamData)
             CMAJ_JAVASCRIPT_BINDING_METHOD (testWriteEventData)
             CMAJ_JAVASCRIPT_BINDING_METHOD (testGetAbsolutePath)
+            CMAJ_JAVASCRIPT_BINDING_METHOD (testReadBaseline)
+            CMAJ_JAVASCRIPT_BINDING_METHOD (testAddToBaseline)
 
             context.evaluate (getWrapperScript());
             context.evaluate (getTestLibrary());
@@ -522,6 +500,7 @@ namespace cmaj::test
         std::ostream& output;
         TestSuite::TestCase* currentTest = nullptr;
         choc::value::Value currentSectionInfo, defaultEngineOptions;
+        bool updateBaselines = false;
 
         void performCommand (bool runDisabled, std::string header)
         {
@@ -572,6 +551,36 @@ namespace cmaj::test
             return choc::value::createString (javascriptEngine->getEngineTypeName());
         }
 
+        choc::value::Value shouldUpdateBaselines (choc::javascript::ArgumentList)
+        {
+            return choc::value::createBool (updateBaselines);
+        }
+
+        /// Returns the process's resident memory size in bytes, or 0 if it's not available
+        /// on this platform.
+        choc::value::Value getMemoryUsage (choc::javascript::ArgumentList)
+        {
+            uint64_t residentBytes = 0;
+
+           #if defined (CHOC_LINUX)
+            if (auto statm = std::ifstream ("/proc/self/statm"))
+            {
+                uint64_t totalPages = 0, residentPages = 0;
+
+                if (statm >> totalPages >> residentPages)
+                    residentBytes = residentPages * static_cast<uint64_t> (sysconf (_SC_PAGESIZE));
+            }
+           #elif defined (CHOC_OSX)
+            mach_task_basic_info info;
+            mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+
+            if (task_info (mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t> (&info), &count) == KERN_SUCCESS)
+                residentBytes = info.resident_size;
+           #endif
+
+            return choc::value::createInt64 (static_cast<int64_t> (residentBytes));
+        }
+
         std::string getErrorString (choc::javascript::ArgumentList args, size_t index)
         {
             if (auto value = args[index])
@@ -845,6 +854,76 @@ namespace cmaj::test
             return choc::value::createString (getFullPath (args.get<std::string> (0)));
         }
 
+        /// Baseline files can be shared by tests that are running on different threads, so
+        /// all reads and writes go through this lock
+        static std::mutex& getBaselineFileLock()
+        {
+            static std::mutex lock;
+            return lock;
+        }
+
+        choc::value::Value testReadBaseline (choc::javascript::ArgumentList args)
+        {
+            auto filename = getFullPath (args.get<std::string> (0));
+            std::lock_guard<std::mutex> lock (getBaselineFileLock());
+
+            if (! std::filesystem::exists (filename))
+                return choc::value::createObject ({});
+
+            try
+            {
+                return choc::json::parse (choc::file::loadFileAsString (filename));
+            }
+            catch (const std::exception& e)
+            {
+                return javascript::createErrorObject (e.what());
+            }
+        }
+
+        /// Merges an object containing some new results into a baseline file
+        choc::value::Value testAddToBaseline (choc::javascript::ArgumentList args)
+        {
+            if (auto newResults = args[1])
+            {
+                auto filename = getFullPath (args.get<std::string> (0));
+                std::lock_guard<std::mutex> lock (getBaselineFileLock());
+
+                try
+                {
+                    auto baseline = std::filesystem::exists (filename) ? choc::json::parse (choc::file::loadFileAsString (filename))
+                                                                       : choc::value::createObject ({});
+                    mergeObjects (baseline, *newResults);
+                    choc::file::replaceFileWithContent (filename, choc::json::toString (baseline, true));
+                    return {};
+                }
+                catch (const std::exception& e)
+                {
+                    return javascript::createErrorObject (e.what());
+                }
+            }
+
+            return javascript::createErrorObject ("Failed to write");
+        }
+
+        static void mergeObjects (choc::value::Value& target, const choc::value::ValueView& source)
+        {
+            for (uint32_t i = 0; i < source.size(); ++i)
+            {
+                auto member = source.getObjectMemberAt (i);
+
+                if (member.value.isObject() && target.hasObjectMember (member.name) && target[member.name].isObject())
+                {
+                    choc::value::Value merged (target[member.name]);
+                    mergeObjects (merged, member.value);
+                    target.setMember (member.name, merged);
+                }
+                else
+                {
+                    target.setMember (member.name, member.value);
+                }
+            }
+        }
+
         std::string getFullPath (const std::string& relativeFilename)
         {
             return (testFile.parent_path() / relativeFilename).string();
@@ -943,11 +1022,15 @@ function TestSection (ts)
     this.readEventData      = function (n)       { return _testReadEventData (n); }
     this.readMidiData       = function (n)       { return _testReadMidiData (n); }
     this.getAbsolutePath    = function (path)    { return _testGetAbsolutePath (path); }
+    this.readBaseline       = function (f)       { return _testReadBaseline (f); }
+    this.addToBaseline      = function (f, r)    { return _testAddToBaseline (f, r); }
 }
 
 function getCurrentTestSection()                     { return new TestSection (_getCurrentTestSection()); }
 function getDefaultEngineOptions()                   { return _getDefaultEngineOptions(); }
 function getEngineName()                             { return _getEngineName(); }
+function getMemoryUsage()                            { return _getMemoryUsage(); }
+function shouldUpdateBaselines()                     { return _shouldUpdateBaselines(); }
 )WRAPPER_SCRIPT";
         }
 
@@ -977,14 +1060,14 @@ function getEngineName()                             { return _getEngineName();
     //==============================================================================
     inline void TestSuite::runTests (std::ostream& console,
                                      const cmaj::BuildSettings& buildSettings, std::optional<int> testToRun,
-                                     bool runDisabled, const choc::value::Value& engineOptions,
+                                     bool runDisabled, bool updateBaselines, const choc::value::Value& engineOptions,
                                      std::string testScriptPath)
     {
         console << thickDivider << std::endl
                 << "Running: " << std::filesystem::path (filename).filename().string() << "   (" << filename << ")" << std::endl
                 << std::endl;
 
-        TestJavascriptEngine testEngine (buildSettings, *this, console, engineOptions, testScriptPath);
+        TestJavascriptEngine testEngine (buildSettings, *this, console, engineOptions, testScriptPath, updateBaselines);
 
         for (auto& test : tests)
         {
@@ -1001,6 +1084,7 @@ function getEngineName()                             { return _getEngineName();
                            std::ostream& output,
                            std::optional<int> testToRun,
                            bool runDisabled,
+                           bool updateBaselines,
                            bool showProgressBar,
                            bool printOnlyErrors,
                            uint32_t threadLimit,
@@ -1009,7 +1093,7 @@ function getEngineName()                             { return _getEngineName();
     {
         if (threadLimit > 1 && ! testToRun.has_value())
         {
-            ThreadPool pool (threadLimit);
+            cmaj::JobThreadPool pool (threadLimit);
 
             std::vector<std::future<std::string>> futures;
             size_t totalNumTests = 0;
@@ -1020,15 +1104,13 @@ function getEngineName()                             { return _getEngineName();
 
                 for (int testIndex = 0; testIndex < (int) suite.tests.size(); ++testIndex)
                 {
-                    futures.emplace_back (std::async (std::launch::async,
-                                                      [&suite, testIndex, &pool, &buildSettings,
-                                                       runDisabled, &engineOptions, testScriptPath] () -> std::string
-                                                      {
-                                                          ThreadAllocator allocateThread (pool);
-                                                          std::ostringstream testOutput;
-                                                          suite.runTests (testOutput, buildSettings, testIndex + 1, runDisabled, engineOptions, testScriptPath);
-                                                          return testOutput.str();
-                                                      }));
+                    futures.emplace_back (pool.addJob ([&suite, testIndex, &buildSettings,
+                                                        runDisabled, updateBaselines, &engineOptions, testScriptPath] () -> std::string
+                                                       {
+                                                           std::ostringstream testOutput;
+                                                           suite.runTests (testOutput, buildSettings, testIndex + 1, runDisabled, updateBaselines, engineOptions, testScriptPath);
+                                                           return testOutput.str();
+                                                       }));
 
                     ++totalNumTests;
                 }
@@ -1037,14 +1119,12 @@ function getEngineName()                             { return _getEngineName();
             {
                 for (auto& suite : testSuites)
                 {
-                    futures.emplace_back (std::async (std::launch::async,
-                                                      [&] () -> std::string
-                                                      {
-                                                          ThreadAllocator allocateThread (pool);
-                                                          std::ostringstream testOutput;
-                                                          suite->runTests (testOutput, buildSettings, {}, runDisabled, engineOptions, testScriptPath);
-                                                          return testOutput.str();
-                                                      }));
+                    futures.emplace_back (pool.addJob ([&] () -> std::string
+                                                       {
+                                                           std::ostringstream testOutput;
+                                                           suite->runTests (testOutput, buildSettings, {}, runDisabled, updateBaselines, engineOptions, testScriptPath);
+                                                           return testOutput.str();
+                                                       }));
 
                     totalNumTests += suite->tests.size();
                 }
@@ -1108,11 +1188,11 @@ function getEngineName()                             { return _getEngineName();
                 if (printOnlyErrors)
                 {
                     std::ostringstream testOutput;
-                    suite->runTests (testOutput, buildSettings, testToRun, runDisabled, engineOptions, testScriptPath);
+                    suite->runTests (testOutput, buildSettings, testToRun, runDisabled, updateBaselines, engineOptions, testScriptPath);
                 }
                 else
                 {
-                    suite->runTests (output, buildSettings, testToRun, runDisabled, engineOptions, testScriptPath);
+                    suite->runTests (output, buildSettings, testToRun, runDisabled, updateBaselines, engineOptions, testScriptPath);
                 }
             }
         }
@@ -1125,6 +1205,7 @@ function getEngineName()                             { return _getEngineName();
                        choc::span<std::string> testFiles,
                        std::optional<int> testToRun,
                        bool runDisabled,
+                       bool updateBaselines,
                        uint32_t threadLimit,
                        int iterations,
                        const choc::value::Value& engineOptions,
@@ -1164,7 +1245,7 @@ function getEngineName()                             { return _getEngineName();
                     testSuites.emplace_back (std::make_unique<TestSuite> (file));
 
                 runSuites (testSuites, buildSettings, output,
-                           testToRun, runDisabled, showProgressBar, printOnlyErrors,
+                           testToRun, runDisabled, updateBaselines, showProgressBar, printOnlyErrors,
                            threadLimit, engineOptions, testScriptPath);
             }
 
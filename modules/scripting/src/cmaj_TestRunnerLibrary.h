@@ -271,13 +271,19 @@ R"(
     ..then it will re-write this line in your test file, adding the actual error
     encountered, which makes it easy to get the correct error string into the test
     file without needing to copy-paste it from the compiler output manually.
+
+    If the options contain a `target`, then rather than linking, the engine generates
+    code for that target, which lets you check errors that only code-generation can
+    produce. If the engine can't generate that target, the test is skipped:)"
+R"(
+
+    ## expectError ("error: Unknown SIMD target 'avx3' - expected one of: native, sse2, avx2, avx512, neon", { simdTarget: "avx3", target: "llvm-x86_64" })
 */
 function expectError (expectedError, options)
 {
     let testSection = getCurrentTestSection();
 
-    let sourceToCompile;)"
-R"TEXT(
+    let sourceToCompile;
 
     if (options != null && options.doNotWrapInTestNamespace)
         sourceToCompile = testSection.source + testSection.globalSource;
@@ -299,7 +305,23 @@ R"TEXT(
         newErrorLine += getErrorReportString (error);
 
         if (! isError (error))
-            newErrorLine += getErrorReportString (engine.link());
+        {
+            if (options?.target != null)
+            {
+                if (! isCodeGenTargetAvailable (engine, options.target))
+                {
+                    testSection.reportUnsupported ("Code generation target " + options.target + " not available");
+                    return;
+                }
+
+                error = engine.generateCode (options.target, {}).messages;
+                newErrorLine += getErrorReportString (error);
+            }
+            else
+            {
+                newErrorLine += getErrorReportString (engine.link());
+            }
+        }
     }
 
     if (newErrorLine.length == 0)
@@ -311,7 +333,8 @@ R"TEXT(
     if (expectedError == null || expectedError.length == 0)
     {
         testSection.reportSuccess();
-        testSection.logMessage ("Updating error text to '" + newErrorLine + "'");
+        testSection.logMessage ("Updating error text to '" + newErrorLine + "'");)"
+R"TEXT(
 
         if (options == null)
             testSection.updateTestHeader ("## expectError (\"" + newErrorLine.replace (/\"/g, "\\\"") + "\")");
@@ -330,8 +353,7 @@ R"TEXT(
         testSection.logMessage ("Expecting " + expectedError);
         testSection.logMessage ("Got       " + newErrorLine);
     }
-})TEXT"
-R"(
+}
 
 //==============================================================================
 /*
@@ -370,7 +392,8 @@ function testFunction (options)
     let callAllTestFunctions = "";
 
     for (let i = 0; i < functions.length; i++)
-        callAllTestFunctions += "        result <- (tests::" + functions[i] + "() ? 1 : 0); advance();\n";
+        callAllTestFunctions += "        result <- (tests::" + functions[i] + "() ? 1 : 0); advance();\n";)TEXT"
+R"(
 
     let processorSource = "processor FunctionTester [[main]]\n"
                         + "{\n"
@@ -388,8 +411,7 @@ function testFunction (options)
     {
         testSection.reportFail (error);
         return;
-    })"
-R"(
+    }
 
     let engine = createEngine (options);
     updateBuildSettings (engine, 44100, 1, ! options?.failOnWarnings, options);
@@ -447,7 +469,8 @@ R"(
     }
 
     testSection.reportSuccess();
-}
+})"
+R"(
 
 //==============================================================================
 /**
@@ -466,8 +489,7 @@ function testCompile (testLink, options)
     let testSection = getCurrentTestSection();
     let timingInfo = {};
     let engine = buildEngineWithLoadedProgram (testSection, options, timingInfo);
-    let error;)"
-R"(
+    let error;
 
     if (isError (engine, options))
     {
@@ -518,6 +540,63 @@ R"(
     testSection.reportSuccess();
 }
 
+//==============================================================================
+/**
+    This test generates code for the given target, and checks that the output
+    contains all of the strings in `contains`, and none of those in `doesNotContain`.
+    If the engine can't generate that target, the test is skipped. Any `codeGenOptions`
+    are passed to the code generator.)"
+R"(
+
+    ## testGeneratedCode ({ target: "llvm-x86_64", simdTarget: "avx2", contains: ["ymm"], doesNotContain: ["zmm"] })
+    ## testGeneratedCode ({ target: "llvm", codeGenOptions: { targetFormat: "ir" }, contains: ["optnone"] })
+*/
+function testGeneratedCode (options)
+{
+    let testSection = getCurrentTestSection();
+    let engine = buildEngineWithLoadedProgram (testSection, options, {});
+
+    if (isError (engine, options))
+    {
+        testSection.reportFail (engine);
+        return;
+    }
+
+    if (! isCodeGenTargetAvailable (engine, options.target))
+    {
+        testSection.reportUnsupported ("Code generation target " + options.target + " not available");
+        return;
+    }
+
+    let generated = engine.generateCode (options.target, options.codeGenOptions ?? {});
+
+    if (isError (generated.messages, options))
+    {
+        testSection.reportFail (generated.messages);
+        return;
+    }
+
+    for (let s of options.contains ?? [])
+    {
+        if (! generated.output.includes (s))
+        {
+            testSection.reportFail ("The generated " + options.target + " code doesn't contain '" + s + "'");
+            return;
+        }
+    }
+
+    for (let s of options.doesNotContain ?? [])
+    {
+        if (generated.output.includes (s))
+        {
+            testSection.reportFail ("The generated " + options.target + " code contains '" + s + "'");
+            return;
+        }
+    }
+
+    testSection.reportSuccess();
+}
+
 //==============================================================================
 /* This test checks whether the console output matches what was expected
 
@@ -536,7 +615,8 @@ function testConsole (expectedConsoleMsg, options)
     {
         testSection.reportFail (error);
         return;
-    }
+    })"
+R"(
 
     let engine = createEngine (options);
     updateBuildSettings (engine, 44100, 1024, true, options);
@@ -554,8 +634,7 @@ function testConsole (expectedConsoleMsg, options)
     if (outputs)
         for (let i = 0; i < outputs.length; ++i)
             if (outputs[i].endpointID == "console")
-                consoleIndex = i;)"
-R"TEXT(
+                consoleIndex = i;
 
     if (consoleIndex < 0)
         testSection.reportFail ("no console output stream found");
@@ -601,7 +680,8 @@ R"TEXT(
         }
 
         framesToRender -= framesPerBlock;
-    }
+    })"
+R"TEXT(
 
     if (! expectedConsoleMsg || expectedConsoleMsg.length == 0)
     {
@@ -625,8 +705,7 @@ R"TEXT(
 //==============================================================================
 /*
     This test builds a processor and renders a given amount of data through it,
-    measuring and reporting its performance.)TEXT"
-R"(
+    measuring and reporting its performance.
 
     e.g.
     ## performanceTest ({ frequency:44100, minBlockSize:4, maxBlockSize: 1024, samplesToRender:100000 })
@@ -663,7 +742,8 @@ function performanceTest (options)
     for (let i = 0; i < inputEndpoints.length; i++)
         inputEndpoints[i].handle = engine.getEndpointHandle (inputEndpoints[i].endpointID);
 
-    let outputEndpoints = engine.getOutputEndpoints();
+    let outputEndpoints = engine.getOutputEndpoints();)TEXT"
+R"(
 
     for (let i = 0; i < outputEndpoints.length; i++)
         outputEndpoints[i].handle = engine.getEndpointHandle (outputEndpoints[i].endpointID);
@@ -686,8 +766,7 @@ function performanceTest (options)
     {
         totalTime += timingInfo.parseTime;
         testSection.logMessage ("Parse time: " + Math.round (timingInfo.parseTime * 1000) + " ms");
-    })"
-R"(
+    }
 
     testSection.logMessage ("Load time : " + Math.round (timingInfo.loadTime * 1000) + " ms");
     testSection.logMessage ("Link time : " + Math.round (timingInfo.linkTime * 1000) + " ms");
@@ -713,7 +792,8 @@ R"(
 
         let runtime = performer.calculateRenderPerformance (blockSize, options.samplesToRender);
         let framesPerSec = options.samplesToRender / runtime;
-        let utilisation = 100.0 * options.frequency / framesPerSec;
+        let utilisation = 100.0 * options.frequency / framesPerSec;)"
+R"(
 
         testSection.logMessage ("Block size " + blockSize + ", runtime " + runtime + ", frames/sec = "
                                  + framesPerSec.toFixed(0) + " utilisation = " + utilisation.toFixed (2));
@@ -723,6 +803,299 @@ R"(
     testSection.reportSuccess();
 }
 
+//==============================================================================
+/*
+    This test measures how long the compiler takes to build a program, rather than
+    how fast the result runs. It either builds a patch, or generates a series of
+    programs of increasing size to check how the build time scales.
+
+    The generators are:
+      "processors"      - a chain of N different processors
+      "graphDepth"      - N graphs, each one nested inside the next
+      "largeArray"      - a processor with an N-element constant table and state array
+      "specialisations" - N different specialisations of a parameterised processor
+
+    Each program is built for every item in the targets list, where "link" means
+    JIT-compiling it with the current engine, and the others are code generation
+    targets such as "cpp" or "javascript". The default is ["link", "cpp", "javascript"].
+
+    The test fails if the build time grows faster than size^maxExponent between two
+    successive sizes (default 1.5), although this is only checked once both builds take
+    at least minScalingTime seconds (default 0.25), as shorter timings are too noisy.
+
+    If a baseline file is given, it also fails if a build has become more than 'tolerance'
+    times slower than its baseline (default 1.5). Results that are missing from the baseline
+    are only logged, unless the tests are run with --updateBaselines, in which case they're
+    added to the file.
+
+    Memory figures show how much the process's resident size grew during each build,
+    so for meaningful results, run these tests with --singleThread.)"
+R"(
+
+    e.g.
+    ## compilePerformanceTest ({ generator: "processors", sizes: [25, 50, 100, 200], baseline: "compile_baseline.json" })
+    ## compilePerformanceTest ({ patch: "../../examples/patches/Pro54/Pro54.cmajorpatch", targets: ["link"] })
+*/
+function compilePerformanceTest (options)
+{
+    const testSection = getCurrentTestSection();
+    const targets = options.targets ?? ["link", "cpp", "javascript"];
+    const sizes = options.generator != null ? options.sizes : [0];
+    const maxExponent = options.maxExponent ?? 1.5;
+    const tolerance = options.tolerance ?? 1.5;
+    const minScalingTime = options.minScalingTime ?? 0.25;
+    const minSignificantTime = 0.05;
+
+    const baseline = options.baseline != null ? testSection.readBaseline (options.baseline) : {};
+
+    if (isError (baseline))
+    {
+        testSection.reportFail (baseline);
+        return;
+    }
+
+    const testName = options.name ?? options.generator ?? options.patch;
+    let missingResults = {}, numMissingResults = 0, failures = [];
+
+    const formatTime = function (seconds)  { return Math.round (seconds * 1000) + " ms"; }
+
+    for (const target of targets)
+    {
+        const resultName = getEngineName() + "/" + target;
+        let previous = null;
+
+        if (target == "link" && (getEngineName() == "webview" || getEngineName() == "webview-binaryen"))
+        {
+            testSection.logMessage (resultName + ": skipped, as this engine can't be linked here");
+            continue;
+        }
+
+        for (const size of sizes)
+        {
+            const source = options.generator != null ? generateCompilePerformanceTestProgram (options.generator, size) : null;
+            const result = measureCompileTime (testSection, options, source, target);
+
+            if (isError (result))
+            {
+                testSection.reportFail (result);
+                return;
+            }
+
+            const description = resultName + (options.generator != null ? ", size " + size : "");)"
+R"(
+
+            testSection.logMessage (description + ": parse " + formatTime (result.parse)
+                                     + ", load " + formatTime (result.load)
+                                     + ", build " + formatTime (result.build)
+                                     + ", total " + formatTime (result.total)
+                                     + (result.memory > 0 ? ", memory " + (result.memory / (1024 * 1024)).toFixed (1) + " MB" : ""));
+
+            if (previous != null && result.total >= minScalingTime && previous.total >= minScalingTime)
+            {
+                const exponent = Math.log (result.total / previous.total) / Math.log (size / previous.size);
+
+                if (exponent > maxExponent)
+                    failures.push (description + ": build time grew as size^" + exponent.toFixed (2) + " since size " + previous.size);
+            }
+
+            previous = { size: size, total: result.total };
+
+            if (options.baseline != null)
+            {
+                const expected = baseline[testName]?.[resultName]?.[size];
+
+                if (expected === undefined)
+                {
+                    if (missingResults[testName] === undefined)
+                        missingResults[testName] = {};
+
+                    if (missingResults[testName][resultName] === undefined)
+                        missingResults[testName][resultName] = {};
+
+                    missingResults[testName][resultName][size] = Number (result.total.toFixed (4));
+                    ++numMissingResults;
+                }
+                else if (result.total > expected * tolerance && result.total - expected > minSignificantTime)
+                {
+                    failures.push (description + ": took " + formatTime (result.total) + ", baseline was " + formatTime (expected));
+                }
+            }
+        }
+    })"
+R"(
+
+    if (numMissingResults != 0)
+    {
+        if (shouldUpdateBaselines())
+        {
+            const error = testSection.addToBaseline (options.baseline, missingResults);
+
+            if (isError (error))
+            {
+                testSection.reportFail (error);
+                return;
+            }
+
+            testSection.logMessage ("Added " + numMissingResults + " results to " + options.baseline);
+        }
+        else
+        {
+            testSection.logMessage (numMissingResults + " results have no baseline in " + options.baseline
+                                     + " - run the tests with --updateBaselines to record them");
+        }
+    }
+
+    if (failures.length != 0)
+    {
+        for (const f of failures)
+            testSection.logMessage (f);
+
+        testSection.reportFail ("compile time regression");
+        return;
+    }
+
+    testSection.reportSuccess();
+}
+
+function measureCompileTime (testSection, options, source, target)
+{
+    const engine = createEngine (options);
+    updateBuildSettings (engine, 44100, 1024, true, options);
+
+    const memoryBefore = getMemoryUsage();
+    let program, externals, parseTime = 0;
+
+    if (source == null)
+    {
+        const patch = new PatchManifest (new File (testSection.getAbsolutePath (options.patch)));
+
+        if (isError (patch.error))
+            return patch.error;
+
+        program = patch.createProgram();
+
+        if (isError (program))
+            return program;
+
+        externals = patch.getExternals();
+    }
+    else
+    {
+        program = new Program();
+        parseTime = program.parse (source);
+
+        if (isError (parseTime))
+            return parseTime;
+    }
+
+    const loadTime = engine.load (program, externals);
+
+    if (isError (loadTime, { failOnWarnings: false }))
+        return loadTime;
+
+    let buildTime;
+
+    if (target == "link")
+    {
+        buildTime = engine.link();)"
+R"(
+
+        if (isError (buildTime, { failOnWarnings: false }))
+            return buildTime;
+    }
+    else
+    {
+        const generated = engine.generateCode (target, {});
+
+        if (isError (generated.messages, { failOnWarnings: false }))
+            return generated.messages;
+
+        buildTime = generated.time;
+    }
+
+    const memory = getMemoryUsage() - memoryBefore;
+
+    engine.release();
+    program.release();
+
+    return { parse: parseTime, load: loadTime, build: buildTime,
+             total: parseTime + loadTime + buildTime,
+             memory: memory };
+}
+
+function generateCompilePerformanceTestProgram (generator, size)
+{
+    const passThrough = function (name, body)
+    {
+        return "processor " + name + "\n{\n    input stream float in;\n    output stream float out;\n\n"
+                + "    void main() { loop { " + body + " advance(); } }\n}\n\n";
+    };
+
+    const mainGraph = function (connection)
+    {
+        return "graph Test [[ main ]]\n{\n    input stream float in;\n    output stream float out;\n\n"
+                + "    connection in -> " + connection + " -> out;\n}\n";
+    };
+
+    let code = "";
+
+    if (generator == "processors")
+    {
+        let names = [];
+
+        for (let i = 0; i < size; ++i)
+        {
+            code += passThrough ("P" + i, "out <- in * " + (i + 1) + ".0f + 0." + i + "f;");
+            names.push ("P" + i);
+        }
+
+        return code + mainGraph (names.join (" -> "));
+    }
+
+    if (generator == "graphDepth")
+    {
+        code += passThrough ("Gain", "out <- in * 0.99f;");
+
+        for (let i = 0; i < size; ++i)
+            code += "graph G" + i + "\n{\n    input stream float in;\n    output stream float out;\n\n"
+                      + "    connection in -> " + (i == 0 ? "Gain" : "G" + (i - 1)) + " -> out;\n}\n\n";
+
+        return code + mainGraph ("G" + (size - 1));
+    }
+
+    if (generator == "largeArray")
+    {
+        let values = [];)"
+R"TEXT(
+
+        for (let i = 0; i < size; ++i)
+            values.push ((Math.sin (i) * 0.5).toFixed (6) + "f");
+
+        return "processor Test [[ main ]]\n{\n    input stream float in;\n    output stream float out;\n\n"
+                + "    let table = float[" + size + "] (" + values.join (", ") + ");\n"
+                + "    float[" + size + "] state;\n\n"
+                + "    void main()\n    {\n        wrap<" + size + "> i;\n\n"
+                + "        loop\n        {\n            state[i] = state[i] * 0.5f + table[i] * in;\n"
+                + "            out <- state[i];\n            ++i;\n            advance();\n        }\n    }\n}\n";
+    }
+
+    if (generator == "specialisations")
+    {
+        code += "processor Delay (float gain, int length)\n{\n    input stream float in;\n    output stream float out;\n\n"
+                 + "    float[length] buffer;\n    wrap<length> pos;\n\n"
+                 + "    void main() { loop { out <- buffer[pos]; buffer[pos] = in * gain; ++pos; advance(); } }\n}\n\n";
+
+        let names = [];
+
+        for (let i = 0; i < size; ++i)
+            names.push ("Delay (" + (i + 1) + ".0f, " + (i % 64 + 1) + ")");
+
+        return code + mainGraph (names.join (" -> "));
+    }
+
+    throw new Error ("Unknown generator: " + generator);
+}
+
 //==============================================================================
 /*
     This test takes the filename of a .cmajorpatch and tries to build it, failing
@@ -738,7 +1111,7 @@ function testPatch (file, expectedError)
     const absolutePath = testSection.getAbsolutePath (file);
     const error = loadAndTestPatch (absolutePath, 44100, 128);
 
-    let newErrorLine = getErrorReportString (error);)"
+    let newErrorLine = getErrorReportString (error);)TEXT"
 R"TEXT(
 
     if (expectedError == null)
@@ -1208,6 +1581,12 @@ R"(
 }
 
 
+function isCodeGenTargetAvailable (engine, target)
+{
+    let targets = engine.getAvailableCodeGenTargetTypes();
+    return Array.isArray (targets) && targets.includes (target);
+}
+
 function createEngine (options)
 {
     let engineOptions = options?.engine;
@@ -1237,6 +1616,8 @@ R"(
         if (options.maxStackSize !== undefined)       buildSettings.maxStackSize = options.maxStackSize;
         if (options.sessionID !== undefined)          buildSettings.sessionID = options.sessionID;
         if (options.optimisationLevel !== undefined)  buildSettings.optimisationLevel = options.optimisationLevel;
+        if (options.mathsApproximationLevel !== undefined)  buildSettings.mathsApproximationLevel = options.mathsApproximationLevel;
+        if (options.simdTarget !== undefined)         buildSettings.simdTarget = options.simdTarget;
         if (options.mainProcessor !== undefined)      buildSettings.mainProcessor = options.mainProcessor;
     }
 
@@ -1267,14 +1648,14 @@ function getErrorReportString (error)
 function findTestFunctions (program)
 {
     let result = [];
-    let syntaxTree = program.getSyntaxTree ("tests");
+    let syntaxTree = program.getSyntaxTree ("tests");)"
+R"(
 
     if (syntaxTree && syntaxTree.name == "tests")
     {
         for (let i = 0; i < syntaxTree.functions.length; ++i)
         {
-            const func = syntaxTree.functions[i];)"
-R"(
+            const func = syntaxTree.functions[i];
 
             if (func.returnType.OBJECT == "PrimitiveType"
                  && func.returnType.type == "boolean"
@@ -1326,12 +1707,12 @@ function streamDataComparison (data, expectedData, maxDiffDb)
             dataFrame = [ dataFrame ];
 
         if (expectedFrame.length != dataFrame.length)
-            return "Channel count mimatch at frame " + i + ", expected " + expectedFrame.length + ", got " + dataFrame.length;
+            return "Channel count mimatch at frame " + i + ", expected " + expectedFrame.length + ", got " + dataFrame.length;)"
+R"(
 
         for (let channel = 0; channel < expectedFrame.length; channel++)
             streamDataCompareValue (comparisonStats, expectedFrame[channel], dataFrame[channel], i, channel);
-    })"
-R"(
+    }
 
     let diffDb = 20.0 * Math.log10 (comparisonStats.maxDiff / comparisonStats.maxValue);
 
@@ -1371,7 +1752,8 @@ function eventDataComparison (data, expectedData)
     }
 
     return null;
-}
+})"
+R"(
 
 // helper function to valid input data for event or value inputs
 function validateInputData (inputName, inputData, testSection, type)
@@ -1382,8 +1764,7 @@ function validateInputData (inputName, inputData, testSection, type)
         {
             testSection.reportFail (inputName + ": Failed validation, missing frameOffset attribute for item " + i);
             return false;
-        })"
-R"(
+        }
 
         if (type == "value")
         {
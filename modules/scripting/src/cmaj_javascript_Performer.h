@@ -527,12 +527,18 @@ private:
             if (! engine)
                 return createErrorObject ("Engine is not valid");
 
+            auto startTime = std::chrono::steady_clock::now();
+
             auto output = engine.generateCode (args.get<std::string> (1),
                                                args[2] != nullptr ? choc::json::toString (*args[2]) : std::string());
 
+            auto endTime = std::chrono::steady_clock::now();
+            std::chrono::duration<double> elapsed = endTime - startTime;
+
             return choc::json::create ("output", output.generatedCode,
                                        "messages", output.messages.toJSON(),
-                                       "mainClass", output.mainClassName);
+                                       "mainClass", output.mainClassName,
+                                       "time", elapsed.count());
         }
 
         choc::value::Value getInputEndpoints() const
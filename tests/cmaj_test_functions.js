@@ -264,6 +264,12 @@ function testProcessor (expectedResult, options)
     ..then it will re-write this line in your test file, adding the actual error
     encountered, which makes it easy to get the correct error string into the test
     file without needing to copy-paste it from the compiler output manually.
+
+    If the options contain a `target`, then rather than linking, the engine generates
+    code for that target, which lets you check errors that only code-generation can
+    produce. If the engine can't generate that target, the test is skipped:
+
+    ## expectError ("error: Unknown SIMD target 'avx3' - expected one of: native, sse2, avx2, avx512, neon", { simdTarget: "avx3", target: "llvm-x86_64" })
 */
 function expectError (expectedError, options)
 {
@@ -291,7 +297,23 @@ function expectError (expectedError, options)
         newErrorLine += getErrorReportString (error);
 
         if (! isError (error))
-            newErrorLine += getErrorReportString (engine.link());
+        {
+            if (options?.target != null)
+            {
+                if (! isCodeGenTargetAvailable (engine, options.target))
+                {
+                    testSection.reportUnsupported ("Code generation target " + options.target + " not available");
+                    return;
+                }
+
+                error = engine.generateCode (options.target, {}).messages;
+                newErrorLine += getErrorReportString (error);
+            }
+            else
+            {
+                newErrorLine += getErrorReportString (engine.link());
+            }
+        }
     }
 
     if (newErrorLine.length == 0)
@@ -507,6 +529,62 @@ function testCompile (testLink, options)
     testSection.reportSuccess();
 }
 
+//==============================================================================
+/**
+    This test generates code for the given target, and checks that the output
+    contains all of the strings in `contains`, and none of those in `doesNotContain`.
+    If the engine can't generate that target, the test is skipped. Any `codeGenOptions`
+    are passed to the code generator.
+
+    ## testGeneratedCode ({ target: "llvm-x86_64", simdTarget: "avx2", contains: ["ymm"], doesNotContain: ["zmm"] })
+    ## testGeneratedCode ({ target: "llvm", codeGenOptions: { targetFormat: "ir" }, contains: ["optnone"] })
+*/
+function testGeneratedCode (options)
+{
+    let testSection = getCurrentTestSection();
+    let engine = buildEngineWithLoadedProgram (testSection, options, {});
+
+    if (isError (engine, options))
+    {
+        testSection.reportFail (engine);
+        return;
+    }
+
+    if (! isCodeGenTargetAvailable (engine, options.target))
+    {
+        testSection.reportUnsupported ("Code generation target " + options.target + " not available");
+        return;
+    }
+
+    let generated = engine.generateCode (options.target, options.codeGenOptions ?? {});
+
+    if (isError (generated.messages, options))
+    {
+        testSection.reportFail (generated.messages);
+        return;
+    }
+
+    for (let s of options.contains ?? [])
+    {
+        if (! generated.output.includes (s))
+        {
+            testSection.reportFail ("The generated " + options.target + " code doesn't contain '" + s + "'");
+            return;
+        }
+    }
+
+    for (let s of options.doesNotContain ?? [])
+    {
+        if (generated.output.includes (s))
+        {
+            testSection.reportFail ("The generated " + options.target + " code contains '" + s + "'");
+            return;
+        }
+    }
+
+    testSection.reportSuccess();
+}
+
 //==============================================================================
 /* This test checks whether the console output matches what was expected
 
@@ -709,6 +787,294 @@ function performanceTest (options)
     testSection.reportSuccess();
 }
 
+//==============================================================================
+/*
+    This test measures how long the compiler takes to build a program, rather than
+    how fast the result runs. It either builds a patch, or generates a series of
+    programs of increasing size to check how the build time scales.
+
+    The generators are:
+      "processors"      - a chain of N different processors
+      "graphDepth"      - N graphs, each one nested inside the next
+      "largeArray"      - a processor with an N-element constant table and state array
+      "specialisations" - N different specialisations of a parameterised processor
+
+    Each program is built for every item in the targets list, where "link" means
+    JIT-compiling it with the current engine, and the others are code generation
+    targets such as "cpp" or "javascript". The default is ["link", "cpp", "javascript"].
+
+    The test fails if the build time grows faster than size^maxExponent between two
+    successive sizes (default 1.5), although this is only checked once both builds take
+    at least minScalingTime seconds (default 0.25), as shorter timings are too noisy.
+
+    If a baseline file is given, it also fails if a build has become more than 'tolerance'
+    times slower than its baseline (default 1.5). Results that are missing from the baseline
+    are only logged, unless the tests are run with --updateBaselines, in which case they're
+    added to the file.
+
+    Memory figures show how much the process's resident size grew during each build,
+    so for meaningful results, run these tests with --singleThread.
+
+    e.g.
+    ## compilePerformanceTest ({ generator: "processors", sizes: [25, 50, 100, 200], baseline: "compile_baseline.json" })
+    ## compilePerformanceTest ({ patch: "../../examples/patches/Pro54/Pro54.cmajorpatch", targets: ["link"] })
+*/
+function compilePerformanceTest (options)
+{
+    const testSection = getCurrentTestSection();
+    const targets = options.targets ?? ["link", "cpp", "javascript"];
+    const sizes = options.generator != null ? options.sizes : [0];
+    const maxExponent = options.maxExponent ?? 1.5;
+    const tolerance = options.tolerance ?? 1.5;
+    const minScalingTime = options.minScalingTime ?? 0.25;
+    const minSignificantTime = 0.05;
+
+    const baseline = options.baseline != null ? testSection.readBaseline (options.baseline) : {};
+
+    if (isError (baseline))
+    {
+        testSection.reportFail (baseline);
+        return;
+    }
+
+    const testName = options.name ?? options.generator ?? options.patch;
+    let missingResults = {}, numMissingResults = 0, failures = [];
+
+    const formatTime = function (seconds)  { return Math.round (seconds * 1000) + " ms"; }
+
+    for (const target of targets)
+    {
+        const resultName = getEngineName() + "/" + target;
+        let previous = null;
+
+        if (target == "link" && (getEngineName() == "webview" || getEngineName() == "webview-binaryen"))
+        {
+            testSection.logMessage (resultName + ": skipped, as this engine can't be linked here");
+            continue;
+        }
+
+        for (const size of sizes)
+        {
+            const source = options.generator != null ? generateCompilePerformanceTestProgram (options.generator, size) : null;
+            const result = measureCompileTime (testSection, options, source, target);
+
+            if (isError (result))
+            {
+                testSection.reportFail (result);
+                return;
+            }
+
+            const description = resultName + (options.generator != null ? ", size " + size : "");
+
+            testSection.logMessage (description + ": parse " + formatTime (result.parse)
+                                     + ", load " + formatTime (result.load)
+                                     + ", build " + formatTime (result.build)
+                                     + ", total " + formatTime (result.total)
+                                     + (result.memory > 0 ? ", memory " + (result.memory / (1024 * 1024)).toFixed (1) + " MB" : ""));
+
+            if (previous != null && result.total >= minScalingTime && previous.total >= minScalingTime)
+            {
+                const exponent = Math.log (result.total / previous.total) / Math.log (size / previous.size);
+
+                if (exponent > maxExponent)
+                    failures.push (description + ": build time grew as size^" + exponent.toFixed (2) + " since size " + previous.size);
+            }
+
+            previous = { size: size, total: result.total };
+
+            if (options.baseline != null)
+            {
+                const expected = baseline[testName]?.[resultName]?.[size];
+
+                if (expected === undefined)
+                {
+                    if (missingResults[testName] === undefined)
+                        missingResults[testName] = {};
+
+                    if (missingResults[testName][resultName] === undefined)
+                        missingResults[testName][resultName] = {};
+
+                    missingResults[testName][resultName][size] = Number (result.total.toFixed (4));
+                    ++numMissingResults;
+                }
+                else if (result.total > expected * tolerance && result.total - expected > minSignificantTime)
+                {
+                    failures.push (description + ": took " + formatTime (result.total) + ", baseline was " + formatTime (expected));
+                }
+            }
+        }
+    }
+
+    if (numMissingResults != 0)
+    {
+        if (shouldUpdateBaselines())
+        {
+            const error = testSection.addToBaseline (options.baseline, missingResults);
+
+            if (isError (error))
+            {
+                testSection.reportFail (error);
+                return;
+            }
+
+            testSection.logMessage ("Added " + numMissingResults + " results to " + options.baseline);
+        }
+        else
+        {
+            testSection.logMessage (numMissingResults + " results have no baseline in " + options.baseline
+                                     + " - run the tests with --updateBaselines to record them");
+        }
+    }
+
+    if (failures.length != 0)
+    {
+        for (const f of failures)
+            testSection.logMessage (f);
+
+        testSection.reportFail ("compile time regression");
+        return;
+    }
+
+    testSection.reportSuccess();
+}
+
+function measureCompileTime (testSection, options, source, target)
+{
+    const engine = createEngine (options);
+    updateBuildSettings (engine, 44100, 1024, true, options);
+
+    const memoryBefore = getMemoryUsage();
+    let program, externals, parseTime = 0;
+
+    if (source == null)
+    {
+        const patch = new PatchManifest (new File (testSection.getAbsolutePath (options.patch)));
+
+        if (isError (patch.error))
+            return patch.error;
+
+        program = patch.createProgram();
+
+        if (isError (program))
+            return program;
+
+        externals = patch.getExternals();
+    }
+    else
+    {
+        program = new Program();
+        parseTime = program.parse (source);
+
+        if (isError (parseTime))
+            return parseTime;
+    }
+
+    const loadTime = engine.load (program, externals);
+
+    if (isError (loadTime, { failOnWarnings: false }))
+        return loadTime;
+
+    let buildTime;
+
+    if (target == "link")
+    {
+        buildTime = engine.link();
+
+        if (isError (buildTime, { failOnWarnings: false }))
+            return buildTime;
+    }
+    else
+    {
+        const generated = engine.generateCode (target, {});
+
+        if (isError (generated.messages, { failOnWarnings: false }))
+            return generated.messages;
+
+        buildTime = generated.time;
+    }
+
+    const memory = getMemoryUsage() - memoryBefore;
+
+    engine.release();
+    program.release();
+
+    return { parse: parseTime, load: loadTime, build: buildTime,
+             total: parseTime + loadTime + buildTime,
+             memory: memory };
+}
+
+function generateCompilePerformanceTestProgram (generator, size)
+{
+    const passThrough = function (name, body)
+    {
+        return "processor " + name + "\n{\n    input stream float in;\n    output stream float out;\n\n"
+                + "    void main() { loop { " + body + " advance(); } }\n}\n\n";
+    };
+
+    const mainGraph = function (connection)
+    {
+        return "graph Test [[ main ]]\n{\n    input stream float in;\n    output stream float out;\n\n"
+                + "    connection in -> " + connection + " -> out;\n}\n";
+    };
+
+    let code = "";
+
+    if (generator == "processors")
+    {
+        let names = [];
+
+        for (let i = 0; i < size; ++i)
+        {
+            code += passThrough ("P" + i, "out <- in * " + (i + 1) + ".0f + 0." + i + "f;");
+            names.push ("P" + i);
+        }
+
+        return code + mainGraph (names.join (" -> "));
+    }
+
+    if (generator == "graphDepth")
+    {
+        code += passThrough ("Gain", "out <- in * 0.99f;");
+
+        for (let i = 0; i < size; ++i)
+            code += "graph G" + i + "\n{\n    input stream float in;\n    output stream float out;\n\n"
+                      + "    connection in -> " + (i == 0 ? "Gain" : "G" + (i - 1)) + " -> out;\n}\n\n";
+
+        return code + mainGraph ("G" + (size - 1));
+    }
+
+    if (generator == "largeArray")
+    {
+        let values = [];
+
+        for (let i = 0; i < size; ++i)
+            values.push ((Math.sin (i) * 0.5).toFixed (6) + "f");
+
+        return "processor Test [[ main ]]\n{\n    input stream float in;\n    output stream float out;\n\n"
+                + "    let table = float[" + size + "] (" + values.join (", ") + ");\n"
+                + "    float[" + size + "] state;\n\n"
+                + "    void main()\n    {\n        wrap<" + size + "> i;\n\n"
+                + "        loop\n        {\n            state[i] = state[i] * 0.5f + table[i] * in;\n"
+                + "            out <- state[i];\n            ++i;\n            advance();\n        }\n    }\n}\n";
+    }
+
+    if (generator == "specialisations")
+    {
+        code += "processor Delay (float gain, int length)\n{\n    input stream float in;\n    output stream float out;\n\n"
+                 + "    float[length] buffer;\n    wrap<length> pos;\n\n"
+                 + "    void main() { loop { out <- buffer[pos]; buffer[pos] = in * gain; ++pos; advance(); } }\n}\n\n";
+
+        let names = [];
+
+        for (let i = 0; i < size; ++i)
+            names.push ("Delay (" + (i + 1) + ".0f, " + (i % 64 + 1) + ")");
+
+        return code + mainGraph (names.join (" -> "));
+    }
+
+    throw new Error ("Unknown generator: " + generator);
+}
+
 //==============================================================================
 /*
     This test takes the filename of a .cmajorpatch and tries to build it, failing
@@ -1185,6 +1551,12 @@ function buildEngineWithLoadedProgram (testSection, options, timingInfo, engine)
 }
 
 
+function isCodeGenTargetAvailable (engine, target)
+{
+    let targets = engine.getAvailableCodeGenTargetTypes();
+    return Array.isArray (targets) && targets.includes (target);
+}
+
 function createEngine (options)
 {
     let engineOptions = options?.engine;
@@ -1213,6 +1585,8 @@ function updateBuildSettings (engine, defaultFrequency, defaultBlockSize, ignore
         if (options.maxStackSize !== undefined)       buildSettings.maxStackSize = options.maxStackSize;
         if (options.sessionID !== undefined)          buildSettings.sessionID = options.sessionID;
         if (options.optimisationLevel !== undefined)  buildSettings.optimisationLevel = options.optimisationLevel;
+        if (options.mathsApproximationLevel !== undefined)  buildSettings.mathsApproximationLevel = options.mathsApproximationLevel;
+        if (options.simdTarget !== undefined)         buildSettings.simdTarget = options.simdTarget;
         if (options.mainProcessor !== undefined)      buildSettings.mainProcessor = options.mainProcessor;
     }
 
@@ -55,6 +55,7 @@ static std::string getCodeGenTargetHelp (std::string_view type)
     if (type == "syntaxtree")     return "Dumps a JSON syntax tree for the code in a patch or some .cmajor files";
     if (type == "html")           return "Generates HTML documentation for some cmajor files";
     if (type == "graph")          return "Generates a graphviz diagram to show a patch's structure";
+    if (type == "stateLayout")    return "Lists the offset and size of each variable in a patch's processor state, as JSON";
     if (type == "cpp")            return "Converts a patch to a self-contained raw C++ class";
     if (type == "javascript")     return "Converts a patch to a Javascript/WebAssembly class";
     if (type == "webaudio")       return "Converts a patch to Javascript/WebAssembly with WebAudio helpers";
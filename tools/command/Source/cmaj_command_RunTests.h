@@ -24,6 +24,7 @@ namespace cmaj::test
                        choc::span<std::string> testFiles,
                        std::optional<int> testToRun,
                        bool runDisabled,
+                       bool updateBaselines,
                        uint32_t threadLimit,
                        int iterations,
                        const choc::value::Value& engineOptions,
@@ -61,6 +62,7 @@ void runTests (juce::ArgumentList& args,
         iterations = args.removeValueForOption ("--iterations").getIntValue();
 
     bool runDisabled = args.removeOptionIfFound ("--runDisabled");
+    bool updateBaselines = args.removeOptionIfFound ("--updateBaselines");
 
     uint32_t threadCount = 0;
 
@@ -101,7 +103,7 @@ void runTests (juce::ArgumentList& args,
         try
         {
             if (! cmaj::test::runTestFiles (buildSettings, std::cerr, xmlFile, paths,
-                                            testToRun, runDisabled, threadCount, iterations,
+                                            testToRun, runDisabled, updateBaselines, threadCount, iterations,
                                             engineOptions, testScriptPath))
                 throw std::exception();
         }
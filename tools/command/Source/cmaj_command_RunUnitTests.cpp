@@ -25,6 +25,7 @@
 #include "unit_tests/cmaj_APIUnitTests.h"
 #include "unit_tests/cmaj_PatchHelperUnitTests.h"
 #include "unit_tests/cmaj_GraphvizUnitTests.h"
+#include "unit_tests/cmaj_CompilerUnitTests.h"
 #include "unit_tests/cmaj_CLAPPluginUnitTests.h"
 
 //==============================================================================
@@ -36,6 +37,7 @@ static void runAllTests (choc::test::TestProgress& progress)
     cmaj::api_tests::runUnitTests (progress);
     cmaj::patch_helper_tests::runUnitTests (progress);
     cmaj::graphviz_tests::runUnitTests (progress);
+    cmaj::compiler_tests::runUnitTests (progress);
     cmaj::plugin::clap::test::runUnitTests (progress);
 }
 
@@ -68,11 +68,16 @@ https://cmajor.dev
 cmaj <command> [options]    Runs the given command. Options can include the following:
 
     -O0|1|2|3|4             Set the optimisation level to the given value
+    --approximateMaths=n    Replace sin, exp, log, pow, tanh etc. with fast polynomial versions.
+                            Level 1 is accurate to about 1e-6, and level 2 to about 1e-4
+    --simdTarget=<name>     Generate native code for the given SIMD instruction set, rather than the
+                            host CPU's: one of sse2, avx2, avx512 (x86-64) or neon (arm)
     --debug                 Turn on debug output from the performer
     --sessionID=n           Set the session id to the given value
     --engine=<type>         Use the specified engine - e.g. llvm, webview, cpp
     --simd                  Enable SIMD support in WASM generation
     --binaryen              Use the binaryen WASM generator
+    --compileProfile=<file> Write a Chrome trace of each build's compiler stages to the given file
 
 Supported commands:
 
@@ -103,6 +108,7 @@ cmaj test [opts] <files>    Runs one or more .cmajtest scripts, and print the ag
     --singleThread          Use a single thread to run the tests
     --threads=n             Run with the given number of threads, defaults to the available cores
     --runDisabled           Run all tests including any marked disabled
+    --updateBaselines       Record any missing results in the baseline files used by compile-time tests
     --testToRun=n           Only run the specified test number in the test files
     --xmlOutput=file        Generate a JUNIT compatible xml file containing the test results
     --iterations=n          How many times to repeat the tests
@@ -160,6 +166,12 @@ static cmaj::BuildSettings parseBuildArgs (juce::ArgumentList& args)
     if (args.removeOptionIfFound ("-debug") || args.removeOptionIfFound ("--debug"))
         buildSettings.setDebugFlag (true);
 
+    if (args.containsOption ("--approximateMaths"))
+        buildSettings.setMathsApproximationLevel (args.removeValueForOption ("--approximateMaths").getIntValue());
+
+    if (args.containsOption ("--simdTarget"))
+        buildSettings.setSIMDTarget (args.removeValueForOption ("--simdTarget").toStdString());
+
     if (args.containsOption ("--sessionID"))
         buildSettings.setSessionID (args.removeValueForOption ("--sessionID").getIntValue());
 
@@ -220,6 +232,9 @@ static choc::value::Value parseEngineArgs (juce::ArgumentList& args)
     if (args.removeOptionIfFound ("--simd"))
         engineOptions.addMember ("simd", true);
 
+    if (args.containsOption ("--compileProfile"))
+        engineOptions.addMember ("compileProfile", args.getFileForOptionAndRemove ("--compileProfile").getFullPathName().toStdString());
+
     return engineOptions;
 }
 
@@ -397,6 +397,112 @@ namespace cmaj::api_tests
         CHOC_EXPECT_EQ (output, "111111");
     }
 
+    static void checkStateLayoutReport (choc::test::TestProgress& progress)
+    {
+        CHOC_TEST (checkStateLayoutReport);
+
+        auto engine = cmaj::Engine::create ({});
+
+        cmaj::Program program;
+        cmaj::DiagnosticMessageList messages;
+
+        program.parse (messages, "", R"(
+            processor Mixed
+            {
+                input stream float32 in;
+                output stream float32 out;
+
+                bool enabled;
+                float32[1000] delayLine;
+                float64 total;
+                float32<4> recent;
+                int32 writePos, count;
+
+                void main()
+                {
+                    loop
+                    {
+                        delayLine[wrap<1000> (writePos)] = in;
+                        recent = recent * 0.5f + in;
+                        total += in;
+                        ++count;
+                        writePos = (writePos + 1) % 1000;
+                        enabled = count > 10;
+                        out <- enabled ? delayLine[wrap<1000> (writePos)] : in;
+                        advance();
+                    }
+                }
+            }
+
+            graph G [[main]]
+            {
+                input stream float32 in;
+                output stream float32 out;
+
+                node mixed = Mixed;
+
+                connection
+                {
+                    in -> mixed.in;
+                    mixed.out -> [100] -> out;
+                }
+            }
+        )");
+
+        CHOC_EXPECT_TRUE (messages.empty());
+
+        engine.setBuildSettings (cmaj::BuildSettings().setFrequency (44100.0)
+                                                      .setMaxBlockSize (32));
+
+        CHOC_EXPECT_TRUE (engine.load (messages, program, {}, {}));
+
+        auto generated = engine.generateCode ("stateLayout", "{}");
+        CHOC_EXPECT_TRUE (generated.messages.empty());
+
+        auto report = choc::json::parse (generated.generatedCode);
+        std::vector<std::string> variables;
+        int64_t endOfPreviousVariable = 0;
+
+        for (auto v : report["variables"])
+        {
+            auto offset = v["offset"].getWithDefault<int64_t> (-1);
+            auto size = v["size"].getWithDefault<int64_t> (-1);
+
+            // The offsets depend on the backend's alignment rules, but the variables mustn't overlap
+            CHOC_EXPECT_TRUE (offset >= endOfPreviousVariable);
+            endOfPreviousVariable = offset + size;
+
+            variables.push_back (std::string (v["name"].getString()) + " " + std::string (v["processor"].getString())
+                                   + " " + std::to_string (size));
+        }
+
+        // The small members come first, sorted by decreasing alignment, followed by the large
+        // ones in order of size, and the flattened node's state is listed where it's stored
+        std::vector<std::string> expected
+        {
+            "_currentFrame G 4",
+            "_state._frequency _G 8",
+            "_state._sessionID _G 4",
+            "_state._delay1.pos std::intrinsics::delay::StreamDelay 4",
+            "_state._delay1._resumeIndex std::intrinsics::delay::StreamDelay 4",
+            "_state._delay1.buffer std::intrinsics::delay::StreamDelay 400",
+            "_state.mixed.recent Mixed 16",
+            "_state.mixed.total Mixed 8",
+            "_state.mixed.writePos Mixed 4",
+            "_state.mixed.count Mixed 4",
+            "_state.mixed._resumeIndex Mixed 4",
+            "_state.mixed.enabled Mixed 1",
+            "_state.mixed.delayLine Mixed 4000"
+        };
+
+        CHOC_EXPECT_EQ (report["processor"].getWithDefault<std::string> ({}), "G");
+        CHOC_EXPECT_EQ (choc::text::joinStrings (variables, ", "), choc::text::joinStrings (expected, ", "));
+
+        // The state size is the backend's size for the whole struct, which only adds padding to the end
+        auto stateSize = report["stateSize"].getWithDefault<int64_t> (0);
+        CHOC_EXPECT_TRUE (stateSize >= endOfPreviousVariable && stateSize < endOfPreviousVariable + 64);
+    }
+
     static void runUnitTests (choc::test::TestProgress& progress)
     {
         CHOC_CATEGORY (Performer);
@@ -405,5 +511,6 @@ namespace cmaj::api_tests
         checkInvalidEngine (progress);
         checkGraph (progress);
         checkOutputEventWithMultipleTypes (progress);
+        checkStateLayoutReport (progress);
     }
 }
@@ -0,0 +1,686 @@
+//
+//     ,ad888ba,                              88
+//    d8"'    "8b
+//   d8            88,dba,,adba,   ,aPP8A.A8  88     The Cmajor Toolkit
+//   Y8,           88    88    88  88     88  88
+//    Y8a.   .a8P  88    88    88  88,   ,88  88     (C)2024 Cmajor Software Ltd
+//     '"Y888Y"'   88    88    88  '"8bbP"Y8  88     https://cmajor.dev
+//                                           ,88
+//                                        888P"
+//
+//  The Cmajor project is subject to commercial or open-source licensing.
+//  You may use it under the terms of the GPLv3 (see www.gnu.org/licenses), or
+//  visit https://cmajor.dev to learn about our commercial licence options.
+//
+//  CMAJOR IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+//  EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+//  DISCLAIMED.
+
+#pragma once
+
+#include <map>
+#include <set>
+#include "choc/text/choc_Wildcard.h"
+#include "../../../modules/compiler/src/passes/cmaj_Passes.h"
+#include "../../../modules/compiler/src/transformations/cmaj_Transformations.h"
+#include "../../../modules/compiler/src/transformations/cmaj_ConvertLargeConstants.h"
+#include "../../../modules/compiler/src/utilities/cmaj_GraphConnectivityModel.h"
+
+namespace cmaj::compiler_tests
+{
+    static std::string getResolutionErrors (AST::Program& program, const std::string& source, bool addStandardLibrary)
+    {
+        DiagnosticMessageList messages;
+
+        catchAllErrors (messages, [&]
+        {
+            auto& file = program.allocator.sourceFileList.add ("test.cmajor", source, false);
+            program.parse (file, false);
+
+            if (addStandardLibrary)
+                program.prepareForLoading();
+
+            transformations::runBasicResolutionPasses (program);
+        });
+
+        return messages.toString();
+    }
+
+    static bool parseAndResolve (AST::Program& program, const std::string& source, bool addStandardLibrary = false)
+    {
+        return getResolutionErrors (program, source, addStandardLibrary).empty();
+    }
+
+    static bool hasModule (AST::Program& program, std::string_view path)
+    {
+        bool found = false;
+
+        program.visitAllModules (false, [&] (AST::ModuleBase& m)
+        {
+            if (m.getFullyQualifiedNameWithoutRoot() == path)
+                found = true;
+        });
+
+        return found;
+    }
+
+    static AST::ModuleBase& findModule (AST::Program& program, std::string_view path)
+    {
+        ptr<AST::ModuleBase> result;
+
+        program.visitAllModules (false, [&] (AST::ModuleBase& m)
+        {
+            if (m.getFullyQualifiedNameWithoutRoot() == path)
+                result = m;
+        });
+
+        CHOC_ASSERT (result != nullptr);
+        return *result;
+    }
+
+    /// A pass that changes nothing, but counts the functions that it visits in each module
+    struct ModuleVisitCounter  : public passes::PassAvoidingGenericFunctionsAndModules
+    {
+        using super = passes::PassAvoidingGenericFunctionsAndModules;
+        using super::visit;
+
+        ModuleVisitCounter (AST::Program& p) : super (p) {}
+
+        void visit (AST::Function& f) override
+        {
+            super::visit (f);
+            ++numFunctionsVisited[f.getParentModule().getFullyQualifiedNameWithoutRoot()];
+        }
+
+        static std::map<std::string, int> run (AST::Program& program, passes::ModuleWorklist& worklist)
+        {
+            ModuleVisitCounter pass (program);
+            pass.worklist = std::addressof (worklist);
+            pass.visitObject (program.rootNamespace);
+            return pass.numFunctionsVisited;
+        }
+
+        std::map<std::string, int> numFunctionsVisited;
+    };
+
+    static void checkWorklistDependencies (choc::test::TestProgress& progress)
+    {
+        CHOC_TEST (checkWorklistDependencies);
+
+        AST::Program program;
+
+        CHOC_EXPECT_TRUE (parseAndResolve (program, R"(
+            namespace callsFunction  { int32 f() { return provider::get(); } }
+            namespace usesType       { int32 f() { provider::S s; return s.x; } }
+            namespace unrelated      { int32 f() { return 1; } }
+
+            namespace provider
+            {
+                struct S { int32 x; }
+                int32 get() { return 3; }
+            }
+        )"));
+
+        passes::ModuleWorklist worklist (program);
+        auto firstSweep = ModuleVisitCounter::run (program, worklist);
+
+        CHOC_EXPECT_EQ (firstSweep.size(), size_t (4));
+
+        // A change in the provider must send everything that refers to it round again
+        worklist.markChanged (findModule (program, "provider"));
+        CHOC_EXPECT_TRUE (worklist.prepareNextSweep (1));
+
+        auto secondSweep = ModuleVisitCounter::run (program, worklist);
+
+        CHOC_EXPECT_EQ (secondSweep["provider"], 1);
+        CHOC_EXPECT_EQ (secondSweep["callsFunction"], 1);
+        CHOC_EXPECT_EQ (secondSweep["usesType"], 1);
+        CHOC_EXPECT_EQ (secondSweep.count ("unrelated"), size_t (0));
+
+        // ..and once a partial sweep has nothing to do, a last full sweep confirms it
+        CHOC_EXPECT_TRUE (worklist.prepareNextSweep (0));
+        CHOC_EXPECT_EQ (ModuleVisitCounter::run (program, worklist).size(), size_t (4));
+        CHOC_EXPECT_FALSE (worklist.prepareNextSweep (0));
+    }
+
+    static void checkWorklistNestedModules (choc::test::TestProgress& progress)
+    {
+        CHOC_TEST (checkWorklistNestedModules);
+
+        AST::Program program;
+
+        CHOC_EXPECT_TRUE (parseAndResolve (program, R"(
+            namespace outer
+            {
+                int32 f() { return 1; }
+
+                namespace inner       { int32 g() { return 2; } }
+                namespace usesOuter   { int32 h() { return outer::f(); } }
+            }
+        )"));
+
+        passes::ModuleWorklist worklist (program);
+        ModuleVisitCounter::run (program, worklist);
+
+        // Revisiting a namespace doesn't walk into the namespaces inside it unless they depend on it
+        worklist.markChanged (findModule (program, "outer"));
+        CHOC_EXPECT_TRUE (worklist.prepareNextSweep (1));
+
+        auto outerChanged = ModuleVisitCounter::run (program, worklist);
+
+        CHOC_EXPECT_EQ (outerChanged["outer"], 1);
+        CHOC_EXPECT_EQ (outerChanged["outer::usesOuter"], 1);
+        CHOC_EXPECT_EQ (outerChanged.count ("outer::inner"), size_t (0));
+
+        // ..and a nested namespace can be revisited without its parent
+        worklist.markChanged (findModule (program, "outer::inner"));
+        CHOC_EXPECT_TRUE (worklist.prepareNextSweep (1));
+
+        auto innerChanged = ModuleVisitCounter::run (program, worklist);
+
+        CHOC_EXPECT_EQ (innerChanged["outer::inner"], 1);
+        CHOC_EXPECT_EQ (innerChanged.count ("outer"), size_t (0));
+        CHOC_EXPECT_EQ (innerChanged.count ("outer::usesOuter"), size_t (0));
+    }
+
+    static void checkWorklistSkipsStandardLibrary (choc::test::TestProgress& progress)
+    {
+        CHOC_TEST (checkWorklistSkipsStandardLibrary);
+
+        {
+            AST::Program program;
+
+            CHOC_EXPECT_TRUE (parseAndResolve (program, R"(
+                namespace user { float32 f() { return std::notes::frequencyToNote (440.0f); } }
+            )", true));
+
+            CHOC_EXPECT_TRUE (findModule (program, "std::notes").isPreResolved);
+
+            // Referring to a pre-resolved module doesn't lead the sweep into it
+            passes::ModuleWorklist worklist (program);
+            auto visited = ModuleVisitCounter::run (program, worklist);
+
+            CHOC_EXPECT_EQ (visited["user"], 1);
+            CHOC_EXPECT_EQ (visited.size(), size_t (1));
+        }
+
+        {
+            AST::Program program;
+
+            CHOC_EXPECT_TRUE (parseAndResolve (program, R"(
+                namespace user { float32 f() { return std::notes::noteToFrequency (60); } }
+            )", true));
+
+            // ..but once a specialisation has been added to it, it gets visited like any other module
+            CHOC_EXPECT_FALSE (findModule (program, "std::notes").isPreResolved);
+
+            passes::ModuleWorklist worklist (program);
+            auto visited = ModuleVisitCounter::run (program, worklist);
+
+            CHOC_EXPECT_EQ (visited["user"], 1);
+            CHOC_EXPECT_TRUE (visited.count ("std::notes") != 0);
+
+            for (auto& v : visited)
+                CHOC_EXPECT_FALSE (findModule (program, v.first).isPreResolved);
+        }
+    }
+
+    static void checkLazyStandardLibraryNamespaces (choc::test::TestProgress& progress)
+    {
+        CHOC_TEST (checkLazyStandardLibraryNamespaces);
+
+        {
+            AST::Program program;
+
+            CHOC_EXPECT_TRUE (parseAndResolve (program, R"(
+                namespace user { float32 f() { return std::notes::frequencyToNote (440.0f); } }
+            )", true));
+
+            // Only the parts of the library that the program uses get attached
+            CHOC_EXPECT_TRUE (hasModule (program, "std::notes"));
+            CHOC_EXPECT_TRUE (hasModule (program, "std::intrinsics"));
+            CHOC_EXPECT_FALSE (hasModule (program, "std::levels"));
+            CHOC_EXPECT_FALSE (hasModule (program, "std::pan_law"));
+            CHOC_EXPECT_FALSE (hasModule (program, "std::envelopes"));
+        }
+
+        {
+            AST::Program program;
+
+            // A qualified name attaches the namespace it refers to when it's first looked up
+            CHOC_EXPECT_TRUE (parseAndResolve (program, R"(
+                namespace user
+                {
+                    float32 f() { return std::levels::dBtoGain (-6.0f); }
+                    float32<2> g() { return std::pan_law::linear (0.5f); }
+                }
+            )", true));
+
+            CHOC_EXPECT_TRUE (hasModule (program, "std::levels"));
+            CHOC_EXPECT_TRUE (hasModule (program, "std::pan_law"));
+            CHOC_EXPECT_FALSE (hasModule (program, "std::envelopes"));
+        }
+
+        {
+            AST::Program program;
+
+            // A user namespace that shares its name with part of the library doesn't attach that part
+            CHOC_EXPECT_TRUE (parseAndResolve (program, R"(
+                namespace levels { float32 gain() { return 0.5f; } }
+                namespace envelopes { float32 attack() { return 0.1f; } }
+                namespace user { float32 f() { return levels::gain() * envelopes::attack(); } }
+            )", true));
+
+            CHOC_EXPECT_FALSE (hasModule (program, "std::levels"));
+            CHOC_EXPECT_FALSE (hasModule (program, "std::envelopes"));
+        }
+
+        {
+            AST::Program program;
+            DiagnosticMessageList messages;
+
+            // ..and a misspelt function is still matched against the parts of the library that aren't attached
+            // (the basic passes leave the call unresolved, and it's the next pass that reports it)
+            CHOC_EXPECT_TRUE (parseAndResolve (program, R"(
+                namespace user { float32 f() { return gainTodB (0.5f); } }
+            )", true));
+
+            catchAllErrors (messages, [&] { passes::runPass<passes::FunctionResolver> (program, true); });
+
+            CHOC_EXPECT_TRUE (choc::text::contains (messages.toString(), "Unknown function: 'gainTodB' (did you mean 'std::levels::gainTodB'?)"));
+        }
+    }
+
+    /// Parses a graph called "G" and returns its execution stages as lists of node names
+    static std::vector<std::vector<std::string>> getExecutionStageNames (const std::string& graphSource)
+    {
+        AST::Program program;
+
+        CHOC_ASSERT (parseAndResolve (program, R"(
+            processor P
+            {
+                input stream float32 in1, in2;
+                output stream float32 out;
+                void main() { loop { out <- in1 + in2; advance(); } }
+            }
+        )" + graphSource));
+
+        auto graph = findModule (program, "G").getAsGraph();
+        CHOC_ASSERT (graph != nullptr);
+
+        std::vector<std::vector<std::string>> result;
+
+        for (auto& stage : GraphConnectivityModel (*graph).getExecutionStages())
+        {
+            auto& names = result.emplace_back();
+
+            for (auto node : stage)
+                names.push_back (std::string (node->getOriginalName()));
+
+            std::sort (names.begin(), names.end());
+        }
+
+        return result;
+    }
+
+    static void checkGraphExecutionStages (choc::test::TestProgress& progress)
+    {
+        CHOC_TEST (checkGraphExecutionStages);
+
+        using Stages = std::vector<std::vector<std::string>>;
+
+        // A diamond: the two middle nodes only depend on the first, so they share a stage
+        CHOC_EXPECT_TRUE (getExecutionStageNames (R"(
+            graph G
+            {
+                input stream float32 in;
+                output stream float32 out;
+                node a = P; node b = P; node c = P; node d = P;
+
+                connection
+                {
+                    in -> a.in1;
+                    a.out -> b.in1, c.in1;
+                    b.out -> d.in1;
+                    c.out -> d.in2;
+                    d.out -> out;
+                }
+            }
+        )") == (Stages { { "a" }, { "b", "c" }, { "d" } }));
+
+        // A chain has no parallelism, and unconnected nodes all land in the first stage
+        CHOC_EXPECT_TRUE (getExecutionStageNames (R"(
+            graph G
+            {
+                input stream float32 in;
+                output stream float32 out;
+                node a = P; node b = P; node c = P; node x = P; node y = P;
+
+                connection
+                {
+                    in -> a.in1, x.in1, y.in1;
+                    a.out -> b.in1;
+                    b.out -> c.in1;
+                    c.out -> out;
+                }
+            }
+        )") == (Stages { { "a", "x", "y" }, { "b" }, { "c" } }));
+
+        // Both ends of a delayed connection use the delay line, so its destination waits for its source
+        CHOC_EXPECT_TRUE (getExecutionStageNames (R"(
+            graph G
+            {
+                input stream float32 in;
+                output stream float32 out;
+                node a = P; node b = P; node c = P;
+
+                connection
+                {
+                    in -> a.in1;
+                    a.out -> [10] -> b.in1;
+                    a.out -> c.in1;
+                    b.out -> c.in2;
+                    c.out -> out;
+                }
+            }
+        )") == (Stages { { "a" }, { "b" }, { "c" } }));
+
+        // ..but a feedback loop through a delay is partitioned as if the loop were cut there
+        CHOC_EXPECT_TRUE (getExecutionStageNames (R"(
+            graph G
+            {
+                input stream float32 in;
+                output stream float32 out;
+                node a = P; node b = P; node c = P;
+
+                connection
+                {
+                    in -> a.in1;
+                    a.out -> b.in1;
+                    b.out -> c.in1;
+                    c.out -> [1] -> a.in2;
+                    c.out -> out;
+                }
+            }
+        )") == (Stages { { "a" }, { "b" }, { "c" } }));
+
+        // Nodes that feed each other through delays still end up in different stages
+        CHOC_EXPECT_TRUE (getExecutionStageNames (R"(
+            graph G
+            {
+                input stream float32 in;
+                output stream float32 out;
+                node a = P; node b = P;
+
+                connection
+                {
+                    in -> a.in1, b.in1;
+                    b.out -> [1] -> a.in2;
+                    a.out -> [1] -> b.in2;
+                    a.out -> out;
+                }
+            }
+        )") == (Stages { { "b" }, { "a" } }));
+
+        // A feedback loop without a delay is an error, but mustn't stop the partitioning from finishing
+        auto invalidFeedback = getExecutionStageNames (R"(
+            graph G
+            {
+                input stream float32 in;
+                output stream float32 out;
+                node a = P; node b = P;
+
+                connection
+                {
+                    in -> a.in1;
+                    a.out -> b.in1;
+                    b.out -> a.in2;
+                    b.out -> out;
+                }
+            }
+        )");
+
+        size_t numNodes = 0;
+
+        for (auto& stage : invalidFeedback)
+            numNodes += stage.size();
+
+        CHOC_EXPECT_EQ (numNodes, size_t (2));
+    }
+
+    static void checkStringPool (choc::test::TestProgress& progress)
+    {
+        CHOC_TEST (checkStringPool);
+
+        choc::memory::Pool memory;
+        AST::StringPool pool (memory);
+
+        CHOC_EXPECT_TRUE (pool.get ("").empty());
+        CHOC_EXPECT_TRUE (pool.get (std::string_view()) == AST::PooledString());
+
+        // Enough strings to make the table grow several times, including some that
+        // are prefixes of each other, and some containing null characters
+        std::vector<std::string> strings;
+
+        for (int i = 0; i < 5000; ++i)
+            strings.push_back ("name" + std::to_string (i));
+
+        strings.push_back ("x");
+        strings.push_back ("xx");
+        strings.push_back (std::string ("x\0y", 3));
+        strings.push_back (std::string ("x\0z", 3));
+
+        std::vector<AST::PooledString> pooled;
+
+        for (auto& s : strings)
+        {
+            pooled.push_back (pool.get (s));
+
+            // A string that has just been added is found again straight away
+            CHOC_EXPECT_TRUE (pool.get (s) == pooled.back());
+        }
+
+        auto bytesUsed = pool.getNumBytesAllocated();
+
+        for (size_t i = 0; i < strings.size(); ++i)
+        {
+            // After the table has been resized, each string still maps to the same pooled
+            // object, whichever kind of string it's looked up with, and holds the same text
+            auto copy = std::string (strings[i]);
+
+            CHOC_EXPECT_TRUE (pool.get (copy) == pooled[i]);
+            CHOC_EXPECT_TRUE (pool.get (std::string_view (copy)) == pooled[i]);
+            CHOC_EXPECT_TRUE (pooled[i].get() == strings[i]);
+            CHOC_EXPECT_TRUE (pooled[i].get().data() != copy.data());
+
+            // ..and strings that differ never share one
+            if (i > 0)
+                CHOC_EXPECT_TRUE (pooled[i] != pooled[i - 1]);
+        }
+
+        CHOC_EXPECT_TRUE (pool.get ("name42") == pooled[42]);
+        CHOC_EXPECT_TRUE (pool.get ("name42").hash() == pooled[42].hash());
+
+        // Looking up strings that are already pooled doesn't allocate anything
+        CHOC_EXPECT_EQ (pool.getNumBytesAllocated(), bytesUsed);
+    }
+
+    /// Finds the globals that a function's large constants have been replaced with, and counts them by type
+    static std::map<std::string, int> getConstantGlobalTypes (AST::Program& program, std::string_view functionPath)
+    {
+        struct ReferenceFinder  : public AST::Visitor
+        {
+            using AST::Visitor::visit;
+            ReferenceFinder (AST::Program& p) : AST::Visitor (p.allocator) {}
+
+            void visit (AST::VariableReference& r) override
+            {
+                auto& v = r.getVariable();
+
+                if (v.getName() == "__constant_")
+                    globals.insert (std::addressof (v));
+            }
+
+            std::set<AST::VariableDeclaration*> globals;
+        };
+
+        ptr<AST::Function> function;
+
+        program.visitAllFunctions (false, [&] (AST::Function& f)
+        {
+            if (f.getFullyQualifiedNameWithoutRoot() == functionPath)
+                function = f;
+        });
+
+        CHOC_ASSERT (function != nullptr);
+
+        ReferenceFinder finder (program);
+        finder.visitObject (*function);
+
+        std::map<std::string, int> result;
+
+        for (auto g : finder.globals)
+            ++result[AST::print (*g->getType())];
+
+        return result;
+    }
+
+    static void checkLargeConstantsAreShared (choc::test::TestProgress& progress)
+    {
+        CHOC_TEST (checkLargeConstantsAreShared);
+
+        std::string values;
+
+        for (int i = 0; i < 40; ++i)
+            values += (i == 0 ? "" : ", ") + std::to_string (i * 3);
+
+        AST::Program program;
+
+        CHOC_EXPECT_TRUE (parseAndResolve (program, R"(
+            namespace test
+            {
+                float32 f (int32 i)
+                {
+                    let a = float32[40] ()" + values + R"();
+                    let b = float32[40] ()" + values + R"();
+                    let c = float64[40] ()" + values + R"();
+                    return a.at (i) + b.at (i + 1) + float32 (c.at (i + 2));
+                }
+            }
+        )"));
+
+        transformations::convertLargeConstantsToGlobals (program);
+
+        // The two identical tables share a global, but the one whose elements have a
+        // different type gets its own, even though its values and their hashes are the same
+        auto globals = getConstantGlobalTypes (program, "test::f");
+
+        CHOC_EXPECT_EQ (globals.size(), size_t (2));
+        CHOC_EXPECT_EQ (globals["float32[40]"], 1);
+        CHOC_EXPECT_EQ (globals["float64[40]"], 1);
+    }
+
+    /// Parses some files into a program, either one at a time or as a batch, and returns any error messages
+    static std::string parseSourceFiles (AST::Program& program, const std::vector<std::string>& sources, bool parseAsBatch)
+    {
+        DiagnosticMessageList messages;
+
+        catchAllErrors (messages, [&]
+        {
+            std::vector<const SourceFile*> files;
+
+            for (size_t i = 0; i < sources.size(); ++i)
+                files.push_back (std::addressof (program.allocator.sourceFileList.add ("file" + std::to_string (i) + ".cmajor", sources[i], false)));
+
+            if (parseAsBatch)
+                return program.parse (files, false);
+
+            for (auto file : files)
+                program.parse (*file, false);
+        });
+
+        return messages.toString();
+    }
+
+    /// Returns each function's name and location, checking that its name belongs to the program's own string pool
+    static std::vector<std::string> getFunctionLocations (AST::Program& program, choc::test::TestProgress& progress)
+    {
+        std::vector<std::string> result;
+
+        program.visitAllFunctions (false, [&] (AST::Function& f)
+        {
+            auto name = f.getName();
+            CHOC_EXPECT_TRUE (name == program.allocator.strings.stringPool.get (name.get()));
+            result.push_back (std::string (name.get()) + " " + choc::text::trim (f.context.getFullLocation().getLocationDescription()));
+        });
+
+        return result;
+    }
+
+    static void checkParsingMultipleFiles (choc::test::TestProgress& progress)
+    {
+        CHOC_TEST (checkParsingMultipleFiles);
+
+        std::vector<std::string> sources;
+
+        for (int i = 0; i < 12; ++i)
+        {
+            auto index = std::to_string (i);
+
+            sources.push_back ("namespace shared { int32 get" + index + "() { return " + index + "; } }\n"
+                               "namespace file" + index + "\n"
+                               "{\n"
+                               "    int32 f() { return shared::get" + index + "(); }\n"
+                               "    int32 g (int32 x) { return x * " + index + "; }\n"
+                               "}\n");
+        }
+
+        {
+            AST::Program serial, batch;
+
+            CHOC_EXPECT_EQ (parseSourceFiles (serial, sources, false), std::string());
+            CHOC_EXPECT_EQ (parseSourceFiles (batch, sources, true), std::string());
+
+            // The namespaces from each file are merged in the same order, and every location
+            // and pooled string refers to the program that the files were parsed into
+            CHOC_EXPECT_EQ (AST::print (batch), AST::print (serial));
+
+            auto serialLocations = getFunctionLocations (serial, progress);
+            auto batchLocations  = getFunctionLocations (batch, progress);
+
+            CHOC_EXPECT_EQ (batchLocations.size(), size_t (36));
+            CHOC_EXPECT_TRUE (batchLocations == serialLocations);
+
+            CHOC_EXPECT_TRUE (parseAndResolve (batch, "namespace user { int32 h() { return file3::f() + file7::g (2); } }"));
+        }
+
+        // When several files have errors, the first one is reported, just as it would be by a serial parse
+        sources[4] = "namespace file4 { int32 f() { return 1 } }";
+        sources[9] = "namespace file9 { int32 f( }";
+
+        {
+            AST::Program serial, batch;
+
+            auto serialErrors = parseSourceFiles (serial, sources, false);
+            auto batchErrors  = parseSourceFiles (batch, sources, true);
+
+            CHOC_EXPECT_TRUE (choc::text::contains (batchErrors, "file4.cmajor:1:"));
+            CHOC_EXPECT_FALSE (choc::text::contains (batchErrors, "file9.cmajor"));
+            CHOC_EXPECT_EQ (batchErrors, serialErrors);
+        }
+    }
+
+    inline void runUnitTests (choc::test::TestProgress& progress)
+    {
+        CHOC_CATEGORY (Compiler);
+
+        checkWorklistDependencies (progress);
+        checkWorklistNestedModules (progress);
+        checkWorklistSkipsStandardLibrary (progress);
+        checkLazyStandardLibraryNamespaces (progress);
+        checkGraphExecutionStages (progress);
+        checkLargeConstantsAreShared (progress);
+        checkStringPool (progress);
+        checkParsingMultipleFiles (progress);
+    }
+}
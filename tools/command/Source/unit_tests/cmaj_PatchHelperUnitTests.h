@@ -19,6 +19,7 @@
 #pragma once
 
 #include "cmajor/helpers/cmaj_Patch.h"
+#include "../../../modules/playback/include/cmaj_AudioPlayer.h"
 
 namespace cmaj::patch_helper_tests
 {
@@ -62,6 +63,70 @@ static PatchManifest createManifestWithInMemoryFiles (const std::string& manifes
     return m;
 }
 
+/// Encodes some values as float32 or float64 data in either byte order
+static std::string createFloatData (const std::vector<double>& values, bool asFloat64, bool bigEndian)
+{
+    std::string result;
+
+    for (auto v : values)
+    {
+        uint64_t bits = 0;
+        auto size = asFloat64 ? sizeof (double) : sizeof (float);
+
+        if (asFloat64)
+        {
+            std::memcpy (&bits, &v, sizeof (double));
+        }
+        else
+        {
+            auto f = static_cast<float> (v);
+            uint32_t bits32;
+            std::memcpy (&bits32, &f, sizeof (float));
+            bits = bits32;
+        }
+
+        for (size_t i = 0; i < size; ++i)
+            result += static_cast<char> (bits >> (8 * (bigEndian ? size - 1 - i : i)));
+    }
+
+    return result;
+}
+
+/// Creates a .npy file with the given header fields, padding the header as numpy does
+static std::string createNpyFile (int majorVersion, const std::string& descr, const std::string& shape, const std::string& data)
+{
+    auto header = "{'descr': '" + descr + "', 'fortran_order': False, 'shape': " + shape + ", }";
+    auto prefixSize = majorVersion == 1 ? size_t (10) : size_t (12);
+
+    while ((prefixSize + header.length() + 1) % 64 != 0)
+        header += ' ';
+
+    header += '\n';
+
+    std::string result ("\x93NUMPY", 6);
+    result += static_cast<char> (majorVersion);
+    result += '\0';
+
+    for (size_t i = 0; i < prefixSize - 8; ++i)
+        result += static_cast<char> (header.length() >> (8 * i));
+
+    return result + header + data;
+}
+
+static std::string getTensorLoadError (const PatchManifest& manifest, const std::string& path, const choc::value::Type& type)
+{
+    try
+    {
+        readManifestResourceAsTensorData (manifest, path, type);
+    }
+    catch (const std::runtime_error& e)
+    {
+        return e.what();
+    }
+
+    return {};
+}
+
 static constexpr bool hasStaticallyLinkedPerformer()
 {
    #ifdef CMAJOR_DLL
@@ -533,6 +598,92 @@ static bool runUnitTests (choc::test::TestProgress& progress)
         CHOC_EXPECT_NEAR (buffer[3], 0.5f, 0.0001f);
     }
 
+    {
+        CHOC_TEST (UpdateValueEndpoint/LatestValueWins)
+
+        const auto manifestSource = R"({
+            "CmajorVersion": 1,
+            "ID": "com.your_name.your_patch_ID",
+            "version": "1.0",
+            "name": "Test",
+            "description": "Test",
+            "category": "generator",
+            "manufacturer": "Your Company Goes Here",
+            "isInstrument": true,
+
+            "source": ["Test.cmajor"]
+        })";
+
+        const auto cmajorSource = R"(
+            graph Test  [[ main ]]
+            {
+                input value float multiplier [[ name: "multiplier" ]];
+                output stream float out;
+
+                node multiplierStream = ValueToStream;
+
+                connection
+                {
+                    multiplier -> multiplierStream.in;
+                    (1.0f * multiplierStream.out) -> out;
+                }
+            }
+
+            processor ValueToStream
+            {
+                input value float in;
+                output stream float out;
+
+                void main()
+                {
+                    loop
+                    {
+                        out <- in;
+                        advance();
+                    }
+                }
+            }
+        )";
+
+        const bool buildSynchronously = true, scanForChanges = false;
+        Patch patch (buildSynchronously, scanForChanges);
+
+        patch.createEngine      = [] { return Engine::create(); };
+
+        patch.stopPlayback      = [] {};
+        patch.startPlayback     = [] {};
+        patch.patchChanged      = [] {};
+        patch.statusChanged     = [] (auto&&...) {};
+        patch.handleOutputEvent = [] (auto&&...) {};
+
+        cmaj::Patch::PlaybackParams params;
+        params.blockSize = 4;
+        params.sampleRate = 4;
+        params.numInputChannels = 0;
+        params.numOutputChannels = 1;
+        patch.setPlaybackParams (params);
+
+        if (! patch.loadPatch ({ createManifestWithInMemoryFiles (manifestSource, {{ "Test.cmajor", cmajorSource }}), {} }))
+        {
+            CHOC_FAIL ("Failed to load patch");
+            return false;
+        }
+
+        std::array<float, 4> buffer { { 0.0f, 0.0f, 0.0f, 0.0f } };
+        std::array<float*, 1> buffers { { buffer.data() } };
+
+        // far more updates than the event FIFO could hold - these should never block, and
+        // only the last one should reach the performer
+        for (int i = 0; i < 10000; ++i)
+            patch.sendEventOrValueToPatch (EndpointID::create (std::string_view ("multiplier")),
+                                           choc::value::Value (static_cast<float> (i)).getView(), 0, 0);
+
+        patch.process (buffers.data(), 4, [] (auto&&...) {});
+
+        CHOC_EXPECT_NEAR (buffer[0], 9999.0f, 0.0001f);
+        CHOC_EXPECT_NEAR (buffer[3], 9999.0f, 0.0001f);
+    }
+
     // N.B. verifies messages can be dispatched without crashing, doesn't verify any side effects
     const auto runBasicClientMessageDispatchTests = [&] (bool shouldCompile)
     {
@@ -1232,6 +1383,465 @@ static bool runUnitTests (choc::test::TestProgress& progress)
         CHOC_EXPECT_NEAR (outputBackingBuffer[3], 0.125f, 0.0001f);
     }
 
+    {
+        CHOC_TEST (RealtimeThreadPool/RunsEveryTask)
+
+        cmaj::RealtimeThreadPool::Options options;
+        options.numWorkerThreads = 3;
+        cmaj::RealtimeThreadPool pool (options);
+
+        std::array<std::atomic<uint32_t>, 64> counts {};
+
+        for (int batch = 0; batch < 1000; ++batch)
+            pool.parallelFor (static_cast<uint32_t> (counts.size()), [&] (uint32_t i) { ++counts[i]; });
+
+        for (auto& c : counts)
+            CHOC_EXPECT_EQ (c.load(), 1000u);
+    }
+
+   #if defined (__linux__)
+    {
+        CHOC_TEST (RealtimeThreadPool/RunsOnRenderingPlayer)
+
+        // The pool is owned by the host and handed to the performer, whose process callback
+        // runs on the rendering player's thread. Pinning and the realtime priority are both
+        // requested, but the latter is quietly skipped if the process isn't allowed it.
+        cmaj::RealtimeThreadPool::Options options;
+        options.numWorkerThreads = 2;
+        options.pinToCores = true;
+        options.realtimePriority = 10;
+        auto pool = std::make_shared<cmaj::RealtimeThreadPool> (options);
+
+        cmaj::Program program;
+        cmaj::DiagnosticMessageList messages;
+
+        program.parse (messages, "", R"(
+            processor Test [[ main ]]
+            {
+                output stream float32<4> out;
+
+                void main()
+                {
+                    loop
+                    {
+                        out <- float32<4> (1.0f, 2.0f, 3.0f, 4.0f);
+                        advance();
+                    }
+                }
+            }
+        )");
+
+        auto engine = Engine::create();
+        engine.setBuildSettings (cmaj::BuildSettings().setFrequency (44100.0).setMaxBlockSize (64));
+
+        if (! engine.load (messages, program, {}, {}))
+        {
+            CHOC_FAIL (messages.toString());
+            return false;
+        }
+
+        AudioMIDIPerformer::Builder builder (engine, 1024);
+        builder.connectAudioOutputTo (engine.getOutputEndpoints().front(), { 0, 1, 2, 3 }, { 0, 1, 2, 3 }, {});
+        builder.setWorkerThreadPool (pool);
+
+        if (! engine.link (messages))
+        {
+            CHOC_FAIL (messages.toString());
+            return false;
+        }
+
+        auto performer = builder.createPerformer();
+        CHOC_EXPECT_TRUE (performer->getWorkerThreadPool() == pool.get());
+        CHOC_EXPECT_TRUE (performer->prepareToStart());
+
+        struct Client  : public cmaj::audio_utils::AudioMIDICallback
+        {
+            Client (AudioMIDIPerformer& p) : performer (p) {}
+
+            void prepareToStart (double, HandleMIDIOutEventFn) override {}
+            void addIncomingMIDIEvent (const void*, uint32_t) override {}
+
+            void process (choc::buffer::ChannelArrayView<const float> input,
+                          choc::buffer::ChannelArrayView<float> output,
+                          bool replaceOutput) override
+            {
+                performer.process ({ input, output, {}, {} }, replaceOutput);
+
+                performer.getWorkerThreadPool()->parallelFor (output.getNumChannels(), [&] (uint32_t channel)
+                {
+                    choc::buffer::applyGain (output.getChannel (channel), 0.5f);
+                    ++tasksRun;
+                });
+            }
+
+            AudioMIDIPerformer& performer;
+            std::atomic<uint32_t> tasksRun { 0 };
+        };
+
+        Client client (*performer);
+
+        constexpr uint32_t numBlocks = 200;
+        uint32_t blocksRendered = 0, blocksWithWrongOutput = 0;
+        std::promise<void> finished;
+
+        cmaj::audio_utils::AudioDeviceOptions deviceOptions;
+        deviceOptions.sampleRate = 44100;
+        deviceOptions.blockSize = 64;
+        deviceOptions.inputChannelCount = 0;
+        deviceOptions.outputChannelCount = 4;
+        deviceOptions.provideInput = [] (auto&&...) { return true; };
+
+        deviceOptions.handleOutput = [&] (choc::buffer::ChannelArrayView<const float> output)
+        {
+            for (uint32_t channel = 0; channel < 4; ++channel)
+                if (output.getSample (channel, 0) != 0.5f * static_cast<float> (channel + 1)
+                     || output.getSample (channel, 63) != 0.5f * static_cast<float> (channel + 1))
+                    ++blocksWithWrongOutput;
+
+            if (++blocksRendered < numBlocks)
+                return true;
+
+            finished.set_value();
+            return false;
+        };
+
+        auto player = cmaj::audio_utils::createRenderingPlayer (deviceOptions);
+        player->start (client);
+        finished.get_future().wait();
+        player->stop();
+
+        CHOC_EXPECT_EQ (blocksRendered, numBlocks);
+        CHOC_EXPECT_EQ (blocksWithWrongOutput, 0u);
+        CHOC_EXPECT_EQ (client.tasksRun.load(), numBlocks * 4);
+    }
+   #endif
+
+    {
+        CHOC_TEST (JobThreadPool/RunsQueuedJobs)
+
+        cmaj::JobThreadPool pool (2);
+        std::atomic<int> total { 0 };
+        std::vector<std::future<int>> jobs;
+
+        for (int i = 1; i <= 100; ++i)
+            jobs.push_back (pool.addJob ([&total, i] { total += i; return i * 2; }));
+
+        int totalOfResults = 0;
+
+        for (auto& j : jobs)
+            totalOfResults += j.get();
+
+        CHOC_EXPECT_EQ (total.load(), 5050);
+        CHOC_EXPECT_EQ (totalOfResults, 10100);
+    }
+
+    {
+        CHOC_TEST (JobThreadPool/GrowsWhenBusy)
+
+        // Each job blocks until all of them have started, which can only happen
+        // if the pool starts a new thread rather than queueing them
+        cmaj::JobThreadPool pool (1, true);
+        constexpr int numJobs = 4;
+        std::atomic<int> numStarted { 0 };
+        std::vector<std::future<bool>> jobs;
+
+        for (int i = 0; i < numJobs; ++i)
+            jobs.push_back (pool.addJob ([&numStarted]
+            {
+                ++numStarted;
+                auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds (10);
+
+                while (numStarted < numJobs)
+                {
+                    if (std::chrono::steady_clock::now() > timeout)
+                        return false;
+
+                    std::this_thread::yield();
+                }
+
+                return true;
+            }));
+
+        for (auto& j : jobs)
+            CHOC_EXPECT_TRUE (j.get());
+    }
+
+    {
+        CHOC_TEST (AudioLevelMeter/BlockLevels)
+
+        // Checks the meter against a straightforward scan of the same block, for sizes that
+        // do and don't fill whole groups of lanes, and for data with a wider stride
+        auto checkBlock = [&] (AudioLevelMeter& meter, const choc::buffer::InterleavedView<float>& block)
+        {
+            meter.process (block);
+
+            CHOC_EXPECT_EQ (meter.blockNumFrames, block.getNumFrames());
+
+            for (uint32_t chan = 0; chan < meter.numChannels; ++chan)
+            {
+                float mn = block.getSample (chan, 0), mx = mn;
+
+                for (uint32_t frame = 0; frame < block.getNumFrames(); ++frame)
+                {
+                    auto sample = block.getSample (chan, frame);
+                    mn = std::min (mn, sample);
+                    mx = std::max (mx, sample);
+                }
+
+                CHOC_EXPECT_EQ (meter.blockMin[chan], mn);
+                CHOC_EXPECT_EQ (meter.blockMax[chan], mx);
+            }
+        };
+
+        for (uint32_t numChannels : { 1u, 2u, 3u })
+        {
+            AudioLevelMeter meter (numChannels);
+
+            for (uint32_t numFrames : { 1u, 7u, 8u, 9u, 64u, 100u, 3u })
+            {
+                choc::buffer::InterleavedBuffer<float> contiguous (numChannels, numFrames), wider (numChannels + 1, numFrames);
+
+                // A loud block, then a quiet one: nothing from the first may leak into the second
+                for (float gain : { 1.0f, 0.01f })
+                {
+                    auto generate = [&] (uint32_t chan, uint32_t frame)
+                    {
+                        return gain * std::sin (static_cast<float> (frame * 7 + chan * 3) * 0.37f) * (chan == 1 ? -2.0f : 1.0f);
+                    };
+
+                    choc::buffer::setAllSamples (contiguous.getView(), generate);
+                    choc::buffer::setAllSamples (wider.getView(), generate);
+
+                    checkBlock (meter, contiguous.getView());
+                    checkBlock (meter, wider.getChannelRange ({ 1, numChannels + 1 }));
+
+                    if (gain < 1.0f)
+                        CHOC_EXPECT_TRUE (meter.blockMax[0] <= 0.02f);
+                }
+            }
+        }
+    }
+
+    {
+        CHOC_TEST (EndpointMonitorFIFO/DropsWhenFull)
+
+        EndpointMonitorFIFO fifo (1024);
+        choc::buffer::InterleavedBuffer<float> block (2, 32);
+        uint32_t numPushed = 0;
+
+        for (uint32_t i = 0; i < 100; ++i)
+        {
+            choc::buffer::setAllSamples (block.getView(), [&] (uint32_t chan, uint32_t frame) { return static_cast<float> (i * 100 + chan * 50 + frame); });
+
+            // The audio thread must never wait for the reader, so a full FIFO just refuses the block
+            if (! fifo.pushAudio (i, block.getView()))
+                break;
+
+            ++numPushed;
+        }
+
+        CHOC_EXPECT_TRUE (numPushed > 0 && numPushed < 100);
+
+        std::vector<uint32_t> received;
+
+        fifo.popAll ([&] (uint32_t index, const choc::buffer::InterleavedView<const float>& b)
+                     {
+                         CHOC_EXPECT_EQ (b.getNumChannels(), 2u);
+                         CHOC_EXPECT_EQ (b.getNumFrames(), 32u);
+                         CHOC_EXPECT_EQ (b.getSample (1, 31), static_cast<float> (index * 100 + 50 + 31));
+                         received.push_back (index);
+                     },
+                     [&] (choc::midi::ShortMessage) { CHOC_FAIL ("Unexpected MIDI"); });
+
+        CHOC_EXPECT_EQ (received.size(), static_cast<size_t> (numPushed));
+        CHOC_EXPECT_EQ (received.back(), numPushed - 1);
+
+        // ..and once it's been read, there's space again
+        CHOC_EXPECT_TRUE (fifo.pushAudio (1000, block.getView()));
+    }
+
+    {
+        CHOC_TEST (EndpointMonitorFIFO/DeliversAcrossThreads)
+
+        EndpointMonitorFIFO fifo (4096);
+        std::atomic<bool> finished { false };
+        uint32_t numAudioReceived = 0, numMIDIReceived = 0, nextExpectedIndex = 0;
+        bool allInOrderAndIntact = true;
+
+        auto readAvailable = [&]
+        {
+            fifo.popAll ([&] (uint32_t index, const choc::buffer::InterleavedView<const float>& b)
+                         {
+                             allInOrderAndIntact = allInOrderAndIntact && index >= nextExpectedIndex
+                                                     && b.getSample (0, 0) == static_cast<float> (index)
+                                                     && b.getSample (2, 15) == static_cast<float> (index);
+                             nextExpectedIndex = index + 1;
+                             ++numAudioReceived;
+                         },
+                         [&] (choc::midi::ShortMessage m)
+                         {
+                             allInOrderAndIntact = allInOrderAndIntact && m.isNoteOn();
+                             ++numMIDIReceived;
+                         });
+        };
+
+        std::thread reader ([&]
+        {
+            while (! finished)
+                readAvailable();
+
+            readAvailable();
+        });
+
+        uint32_t numAudioPushed = 0, numMIDIPushed = 0;
+        choc::buffer::InterleavedBuffer<double> block (3, 16);
+        std::vector<choc::midi::ShortMessage> notes (4, choc::midi::ShortMessage (0x90, 60, 100));
+
+        for (uint32_t i = 0; i < 5000; ++i)
+        {
+            choc::buffer::setAllSamples (block.getView(), [=] (uint32_t, uint32_t) { return static_cast<double> (i); });
+
+            if (fifo.pushAudio (i, block.getView()))
+                ++numAudioPushed;
+
+            if (i % 10 == 0 && fifo.pushMIDI (notes))
+                numMIDIPushed += static_cast<uint32_t> (notes.size());
+        }
+
+        finished = true;
+        reader.join();
+
+        CHOC_EXPECT_TRUE (allInOrderAndIntact);
+        CHOC_EXPECT_EQ (numAudioReceived, numAudioPushed);
+        CHOC_EXPECT_EQ (numMIDIReceived, numMIDIPushed);
+    }
+
+    {
+        using choc::value::Type;
+
+        const auto manifestSource = R"({
+            "CmajorVersion": 1,
+            "ID": "com.your_name.your_patch_ID",
+            "version": "1.0",
+            "name": "Test",
+            "source": ["Test.cmajor"],
+            "externals": { "Test::weights": "wrongShape.npy" }
+        })";
+
+        auto npyVersion1   = createNpyFile (1, "<f4", "(2, 3)", createFloatData ({ 1, 2, 3, 4, 5, 6 }, false, false));
+        auto npyVersion2   = createNpyFile (2, ">f8", "(4,)",   createFloatData ({ 0.5, -1.5, 2.5, 1.0e100 }, true, true));
+        auto npyInts       = createNpyFile (1, "<i4", "(2,)",   std::string (8, '\0'));
+        auto npyScalar     = createNpyFile (1, "<f8", "()",     createFloatData ({ 0.25 }, true, false));
+        auto npyBadShape   = createNpyFile (1, "<f4", "(2, x)", createFloatData ({ 1, 2 }, false, false));
+        auto npyHugeShape  = createNpyFile (1, "<f4", "(99999999999999999999999,)", createFloatData ({ 1 }, false, false));
+        auto rawFloat32    = createFloatData ({ 0.125, -0.25, 8 }, false, false);
+        auto rawTruncated  = rawFloat32.substr (0, 5);
+
+        auto manifest = createManifestWithInMemoryFiles (manifestSource,
+                                                         {{ "Test.cmajor",      "namespace Test {}" },
+                                                          { "v1.npy",           npyVersion1 },
+                                                          { "v2.npy",           npyVersion2 },
+                                                          { "wrongShape.npy",   npyVersion1 },
+                                                          { "ints.npy",         npyInts },
+                                                          { "scalar.npy",       npyScalar },
+                                                          { "badShape.npy",     npyBadShape },
+                                                          { "hugeShape.npy",    npyHugeShape },
+                                                          { "values.f32",       rawFloat32 },
+                                                          { "truncated.f32",    rawTruncated }});
+
+        auto float32Array2x3 = Type::createArray (Type::createArray (Type::createFloat32(), 3), 2);
+
+        {
+            CHOC_TEST (TensorData/NpyVersion1)
+
+            auto v = readManifestResourceAsTensorData (manifest, "v1.npy", float32Array2x3);
+
+            CHOC_EXPECT_TRUE (v.getType() == float32Array2x3);
+            CHOC_EXPECT_EQ (v[0][0].get<float>(), 1.0f);
+            CHOC_EXPECT_EQ (v[0][2].get<float>(), 3.0f);
+            CHOC_EXPECT_EQ (v[1][0].get<float>(), 4.0f);
+            CHOC_EXPECT_EQ (v[1][2].get<float>(), 6.0f);
+
+            // ..converted to float64 on the way in
+            auto f64 = readManifestResourceAsTensorData (manifest, "v1.npy", Type::createArray (Type::createVector (Type::createFloat64(), 3), 2));
+            CHOC_EXPECT_EQ (f64[1][1].get<double>(), 5.0);
+
+            auto scalar = readManifestResourceAsTensorData (manifest, "scalar.npy", Type::createFloat64());
+            CHOC_EXPECT_EQ (scalar.get<double>(), 0.25);
+        }
+
+        {
+            CHOC_TEST (TensorData/NpyVersion2BigEndian)
+
+            auto v = readManifestResourceAsTensorData (manifest, "v2.npy", Type::createVector (Type::createFloat64(), 4));
+
+            CHOC_EXPECT_EQ (v[0].get<double>(), 0.5);
+            CHOC_EXPECT_EQ (v[1].get<double>(), -1.5);
+            CHOC_EXPECT_EQ (v[2].get<double>(), 2.5);
+            CHOC_EXPECT_EQ (v[3].get<double>(), 1.0e100);
+        }
+
+        {
+            CHOC_TEST (TensorData/Float32ToFloat64)
+
+            auto v = readManifestResourceAsTensorData (manifest, "values.f32", Type::createArray (Type::createFloat64(), 3));
+
+            CHOC_EXPECT_EQ (v.size(), 3u);
+            CHOC_EXPECT_EQ (v[0].get<double>(), 0.125);
+            CHOC_EXPECT_EQ (v[1].get<double>(), -0.25);
+            CHOC_EXPECT_EQ (v[2].get<double>(), 8.0);
+        }
+
+        {
+            CHOC_TEST (TensorData/UnsizedArrays)
+
+            auto raw = readManifestResourceAsTensorData (manifest, "values.f32", Type::createArray (Type::createFloat32(), 0));
+            CHOC_EXPECT_EQ (raw.size(), 3u);
+            CHOC_EXPECT_EQ (raw[2].get<float>(), 8.0f);
+
+            auto npy = readManifestResourceAsTensorData (manifest, "v2.npy", Type::createArray (Type::createFloat32(), 0));
+            CHOC_EXPECT_EQ (npy.size(), 4u);
+            CHOC_EXPECT_EQ (npy[1].get<float>(), -1.5f);
+
+            CHOC_EXPECT_TRUE (choc::text::contains (getTensorLoadError (manifest, "v1.npy", Type::createArray (Type::createFloat32(), 0)),
+                                                    "must be one-dimensional"));
+        }
+
+        {
+            CHOC_TEST (TensorData/MismatchErrors)
+
+            CHOC_EXPECT_TRUE (readManifestResourceAsTensorData (manifest, "Test.cmajor", float32Array2x3).isVoid());
+
+            CHOC_EXPECT_EQ (getTensorLoadError (manifest, "v1.npy", Type::createArray (Type::createFloat32(), 6)),
+                            std::string ("Cannot load \"v1.npy\": the .npy shape (2, 3) doesn't match the target dimensions (6)"));
+
+            CHOC_EXPECT_EQ (getTensorLoadError (manifest, "values.f32", Type::createArray (Type::createFloat32(), 4)),
+                            std::string ("Cannot load \"values.f32\": the file contains 3 values, but the target needs 4"));
+
+            CHOC_EXPECT_TRUE (choc::text::contains (getTensorLoadError (manifest, "ints.npy", Type::createArray (Type::createFloat32(), 2)),
+                                                    "'<i4' is not supported"));
+            CHOC_EXPECT_TRUE (choc::text::contains (getTensorLoadError (manifest, "values.f32", Type::createArray (Type::createInt32(), 3)),
+                                                    "must be a float"));
+            CHOC_EXPECT_TRUE (choc::text::contains (getTensorLoadError (manifest, "truncated.f32", Type::createArray (Type::createFloat32(), 1)),
+                                                    "not a multiple"));
+            CHOC_EXPECT_TRUE (choc::text::contains (getTensorLoadError (manifest, "missing.npy", float32Array2x3),
+                                                    "could not be opened"));
+            CHOC_EXPECT_EQ (getTensorLoadError (manifest, "badShape.npy", Type::createArray (Type::createFloat32(), 2)),
+                            std::string ("Cannot load \"badShape.npy\": the .npy header has an invalid shape"));
+            CHOC_EXPECT_EQ (getTensorLoadError (manifest, "hugeShape.npy", Type::createArray (Type::createFloat32(), 1)),
+                            std::string ("Cannot load \"hugeShape.npy\": the .npy header has an invalid shape"));
+
+            // The resolver can't throw through the engine, so it passes the reason on instead
+            std::string reportedError;
+
+            auto resolver = manifest.createExternalResolverFunction ([&] (const std::string& e) { reportedError = e; });
+            auto resolved = resolver ({ "Test::weights", Type::createArray (Type::createFloat32(), 6), {} });
+
+            CHOC_EXPECT_TRUE (resolved.isVoid());
+            CHOC_EXPECT_TRUE (choc::text::startsWith (reportedError, "External variable Test::weights: Cannot load \"wrongShape.npy\""));
+        }
+    }
+
     return progress.numFails == 0;
 }
 
@@ -18,7 +18,7 @@
 #  EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
 #  DISCLAIMED.
 
-import sys, shutil, os, getopt, json, math
+import sys, shutil, os, getopt, json, math, struct
 
 patchTemplateDir = os.path.dirname(os.path.abspath(sys.argv[0])) + "/patchTemplate"
 
@@ -31,6 +31,10 @@ connections = []
 initialisers = []
 layerIds = []
 
+useBinaryWeights = False
+weightExternals = []
+weightFiles = {}
+
 nextLayerId = 0
 
 nodeNamesMap = {
@@ -113,8 +117,32 @@ def parseActivationFn (layer):
 
     return layer["activation"]
 
+def flattenArray (data):
+
+    if not isinstance (data, list):
+        return [float (data)]
+
+    items = []
+
+    for i in data:
+        items.extend (flattenArray (i))
+
+    return items
+
 def parseInitialiser (name, data):
     cmajType = createCmajArrayType (data, elementType)
+
+    if useBinaryWeights:
+        # The weights are written to a file which the patch loads into an external
+        # variable, so that the compiler doesn't have to parse them as literals
+        values = flattenArray (data)
+        format = "d" if elementType == "float64" else "f"
+        extension = "f64" if elementType == "float64" else "f32"
+        weightFiles[f"weights/{name}.{extension}"] = struct.pack (f"<{len (values)}{format}", *values)
+        weightExternals.append (f"    external {cmajType} {name};")
+        initialisers.append (f"    let {name} = weights::{name};")
+        return
+
     dataString = createCmajArray (data, elementSuffix)
     initialisers.append (f"    let {name} = {cmajType} {dataString};")
 
@@ -285,13 +313,33 @@ def generateNodesAndConnections (model):
 
     return
 
+def getWeightsNamespace():
+    if len (weightExternals) == 0:
+        return ""
+
+    return "\nnamespace weights\n{\n" + "\n".join (weightExternals) + "\n}\n"
+
+def getManifestExternals():
+    if len (weightFiles) == 0:
+        return ""
+
+    items = []
+
+    for path in weightFiles:
+        name = os.path.splitext (os.path.basename (path))[0]
+        items.append (f"        \"weights::{name}\": \"{path}\"")
+
+    return ",\n\n    \"externals\": {\n" + ",\n".join (items) + "\n    }"
+
 def replacePlaceholders (str, name):
     return str.replace("{NODES}", "\n".join (nodes)) \
               .replace("{NAME}", name) \
               .replace("{ELEMENT_TYPE}", elementType) \
               .replace("{IOBLOCK}", "\n".join (ioBlock)) \
               .replace("{CONNECTIONS}", "\n".join (connections)) \
-              .replace("{INITIALISERS}", "\n".join (initialisers))
+              .replace("{INITIALISERS}", "\n".join (initialisers)) \
+              .replace("{WEIGHTS}", getWeightsNamespace()) \
+              .replace("{EXTERNALS}", getManifestExternals())
 
 
 def printCmajor (name, patchDir):
@@ -321,6 +369,12 @@ def printCmajor (name, patchDir):
             f.write (patchBody)
             f.close()
 
+        for path, data in weightFiles.items():
+            os.makedirs (os.path.dirname (patchDir + "/" + path), exist_ok = True)
+
+            with open (patchDir + "/" + path, "wb") as f:
+                f.write (data)
+
 
 def usage():
     print (
@@ -334,6 +388,9 @@ def usage():
     --outputDir <folder> Specifies a folder into which the generated patch will be written
     --name <name>        Optional name for the model - defaults to "Model"
     --useFloat64         By default we use float32, but this changes the generated model to float64
+    --binaryWeights      Writes the weights into binary files which the patch loads as externals,
+                         rather than as array literals in the Cmajor code. This makes large models
+                         much quicker to load. It needs an outputDir to be specified.
 
   If no patchDir argument is supplied, the output will be a single Cmajor file.
 
@@ -342,14 +399,14 @@ def usage():
 
 def main(argv):
 
-    global elementType, elementSuffix
+    global elementType, elementSuffix, useBinaryWeights
 
     if len(argv) == 0:
         usage()
         exit(1)
 
     try:
-        opts, args = getopt.getopt (argv, "h", ["outputDir=", "model=", "name=", "useFloat64"])
+        opts, args = getopt.getopt (argv, "h", ["outputDir=", "model=", "name=", "useFloat64", "binaryWeights"])
     except getopt.GetoptError as e:
         print (f"{e}")
         usage()
@@ -378,6 +435,13 @@ def main(argv):
             elementType = "float64"
             elementSuffix = ""
 
+        if opt in ("--binaryWeights"):
+            useBinaryWeights = True
+
+    if useBinaryWeights and patchDir == None:
+        print ("The --binaryWeights option needs an outputDir")
+        usage()
+        exit (1)
     if model == None:
         model = args[0]
 